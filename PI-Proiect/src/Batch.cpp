@@ -0,0 +1,224 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Batch.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <numeric>
+
+namespace {
+	const std::vector<std::string> image_extensions = { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp" };
+
+	bool is_image_file(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		return std::find(image_extensions.begin(), image_extensions.end(), extension) != image_extensions.end();
+	}
+
+	struct StageStatistics
+	{
+		std::vector<double> decode;
+		std::vector<double> detect;
+		std::vector<double> read;
+	};
+
+	void report_stage(const std::string& name, std::vector<double> times)
+	{
+		if (times.empty())
+		{
+			return;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		double mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+		double p95 = times[std::min(times.size() - 1, (size_t)std::ceil(times.size() * 0.95) - 1)];
+
+		std::cerr << "  " << std::left << std::setw(8) << name << std::right
+			<< " mean " << std::fixed << std::setprecision(2) << mean << " ms"
+			<< ", p95 " << p95 << " ms" << std::defaultfloat << std::endl;
+	}
+}
+
+std::vector<std::string> list_batch_inputs(const std::string& input)
+{
+	std::vector<std::string> files;
+
+	std::error_code error;
+
+	if (std::filesystem::is_directory(input, error))
+	{
+		for (auto& entry : std::filesystem::directory_iterator(input, error))
+		{
+			if (entry.is_regular_file(error) && is_image_file(entry.path()))
+			{
+				files.push_back(entry.path().string());
+			}
+		}
+
+		std::sort(files.begin(), files.end());
+
+		return files;
+	}
+
+	std::ifstream list(input);
+
+	if (!list.good())
+	{
+		std::cerr << "Failed to open " << input << std::endl;
+		return files;
+	}
+
+	std::string line;
+
+	while (std::getline(list, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if (!line.empty() && line[0] != '#')
+		{
+			files.push_back(line);
+		}
+	}
+
+	return files;
+}
+
+int run_batch(const FontData& fontData, const std::vector<std::string>& files,
+	const DetectionSettings& detection, const ReadSettings& read, const BatchSettings& settings)
+{
+	int threads = settings.threads > 0 ? settings.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max(1, std::min(threads, (int)files.size()));
+
+	std::ofstream file;
+
+	if (!settings.output.empty())
+	{
+		file.open(settings.output);
+
+		if (!file.good())
+		{
+			std::cerr << "Failed to open " << settings.output << std::endl;
+			return (int)files.size();
+		}
+	}
+
+	std::ostream& output = settings.output.empty() ? std::cout : file;
+
+	// The workers already keep every core busy, OpenCV's own threads would only fight over them
+
+	int opencv_threads = cv::getNumThreads();
+
+	if (threads > 1)
+	{
+		cv::setNumThreads(1);
+	}
+
+	std::atomic<size_t> next(0);
+	std::atomic<int> failures(0);
+
+	std::mutex output_lock;
+	StageStatistics statistics;
+
+	auto worker = [&]()
+	{
+		// Scratch state of this worker, nothing here is shared with the others
+
+		pi::WarpCache warp_cache;
+
+		DetectionSettings worker_detection = detection;
+		worker_detection.warp_cache = &warp_cache;
+		worker_detection.draw = false;
+
+		for (size_t index = next++; index < files.size(); index = next++)
+		{
+			const std::string& path = files[index];
+
+			std::ostringstream record;
+			record << "{\"file\":" << json_string(path);
+
+			auto start = std::chrono::steady_clock::now();
+			cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+			double decode = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			FrameResult result;
+			bool decoded = !image.empty();
+
+			if (decoded)
+			{
+				try
+				{
+					result = process_frame(fontData, image, worker_detection, read);
+					result.times.decode = decode;
+
+					record << ",\"ok\":true,\"width\":" << image.cols << ",\"height\":" << image.rows
+						<< ",\"plates\":" << plates_to_json(result)
+						<< ",\"ms\":{\"decode\":" << result.times.decode << ",\"detect\":" << result.times.detect
+						<< ",\"read\":" << result.times.read << "}";
+				}
+				catch (std::exception& e)
+				{
+					decoded = false;
+					record << ",\"ok\":false,\"error\":" << json_string(e.what());
+				}
+			}
+			else
+			{
+				record << ",\"ok\":false,\"error\":\"failed to decode\"";
+			}
+
+			record << "}\n";
+
+			if (!decoded)
+			{
+				failures++;
+			}
+
+			std::lock_guard<std::mutex> guard(output_lock);
+
+			output << record.str();
+
+			if (decoded)
+			{
+				statistics.decode.push_back(result.times.decode);
+				statistics.detect.push_back(result.times.detect);
+				statistics.read.push_back(result.times.read);
+			}
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> pool;
+
+	for (int i = BASE_VALUE; i < threads; i++)
+	{
+		pool.emplace_back(worker);
+	}
+
+	for (auto& thread : pool)
+	{
+		thread.join();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	output.flush();
+	cv::setNumThreads(opencv_threads);
+
+	std::cerr << "Processed " << files.size() << " images (" << failures << " failed) in " << seconds << " s on "
+		<< threads << " threads, " << files.size() / std::max(seconds, 1e-9) << " images/s" << std::endl;
+
+	report_stage("decode", statistics.decode);
+	report_stage("detect", statistics.detect);
+	report_stage("read", statistics.read);
+
+	return failures;
+}
@@ -0,0 +1,43 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Pipeline.hpp"
+
+/*************************************************************************************************/
+/*                                       Defines & types                                         */
+/*************************************************************************************************/
+
+struct BatchSettings
+{
+	// Worker threads, 0 for one per hardware thread
+	int threads = 0;
+
+	// JSONL file the records go to, empty for the standard output
+	std::string output;
+};
+
+/**************************************************************************************************/
+/*                                     Public Functions                                          */
+/**************************************************************************************************/
+
+/**
+ * \brief Function that lists the images of a batch
+ *
+ * \param[in] input - a directory, whose images are taken in name order, or a text file with one image path per line
+ */
+std::vector<std::string> list_batch_inputs(const std::string& input);
+
+/**
+ * \brief Function that reads the plates of many images on a pool of worker threads, without any window
+ *
+ * \param[out] returns the number of images that couldn't be decoded
+ *
+ * \note Writes one JSON record per image as soon as it is done, so the order of the records isn't the input order
+ *       Images per second and the mean and 95th percentile latency of every stage go to the error output at the end
+ */
+int run_batch(const FontData& fontData, const std::vector<std::string>& files,
+	const DetectionSettings& detection, const ReadSettings& read, const BatchSettings& settings);
@@ -0,0 +1,83 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Candidates.hpp"
+#include "Helper.hpp"
+
+namespace pi {
+
+	double intersectionOverUnion(const cv::Rect& left, const cv::Rect& right) {
+		double intersection = (left & right).area();
+		double total = (double)left.area() + right.area() - intersection;
+
+		if (total <= 0.0) {
+			return 0.0;
+		}
+
+		return intersection / total;
+	}
+
+	void scorePlateCandidate(PlateCandidate& candidate, const cv::Mat& image, const cv::Mat& edges, const CandidateSettings& settings) {
+		cv::Rect box = candidate.box & cv::Rect(0, 0, image.cols, image.rows);
+
+		if (box.area() == 0) {
+			candidate.score = 0.0;
+			return;
+		}
+
+		double rotated_area = cv::minAreaRect(candidate.contour).size.area();
+		double contour_area = cv::contourArea(candidate.contour);
+
+		candidate.rectangularity = rotated_area > 0.0 ? std::min(contour_area / rotated_area, 1.0) : 0.0;
+
+		cv::Mat region = image(box);
+		candidate.color_match = pi::getColorMatch(region, settings.plate_color);
+
+		candidate.edge_density = cv::countNonZero(edges(box)) / (double)box.area();
+
+		// Plates with text usually sit around 15-25% edge pixels
+		// Anything above that is as good as it gets
+
+		const double edge_density_full = 0.2;
+
+		double edge_score = std::min(candidate.edge_density / edge_density_full, 1.0);
+
+		candidate.score = 0.4 * candidate.rectangularity + 0.3 * candidate.color_match + 0.3 * edge_score;
+	}
+
+	std::vector<PlateCandidate> suppressNonMaximum(std::vector<PlateCandidate> candidates, const CandidateSettings& settings) {
+		auto score_greater = [](const PlateCandidate& left, const PlateCandidate& right) { return left.score > right.score; };
+
+		std::stable_sort(candidates.begin(), candidates.end(), score_greater);
+
+		std::vector<PlateCandidate> result;
+
+		for (auto& candidate : candidates) {
+			if (settings.top_k > 0 && (int)result.size() >= settings.top_k) {
+				break;
+			}
+
+			bool suppressed = false;
+
+			for (auto& kept : result) {
+				double intersection = (candidate.box & kept.box).area();
+				double smaller = std::min(candidate.box.area(), kept.box.area());
+
+				// Nested contours (plate border and inner text area) barely overlap by IoU,
+				// so also check how much of the smaller box is covered
+
+				if (intersectionOverUnion(candidate.box, kept.box) > settings.iou_thresh ||
+					(smaller > 0.0 && intersection / smaller > settings.nested_thresh)) {
+					suppressed = true;
+					break;
+				}
+			}
+
+			if (!suppressed) {
+				result.push_back(std::move(candidate));
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,70 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*a region of the image that may contain a license plate*/
+	struct PlateCandidate {
+		std::vector<cv::Point> contour;
+		cv::Rect box;
+
+		int spec_index = -1;  // Index of the matched format in pi::defaultPlateSpecs()
+
+		double rectangularity = 0.0;  // Contour area / area of the minimum rotated rectangle
+		double color_match = 0.0;     // Ratio of pixels close to the plate background color
+		double edge_density = 0.0;    // Ratio of edge pixels inside the box
+
+		double score = 0.0;
+	};
+
+	/*parameters for selecting the candidates that go downstream*/
+	struct CandidateSettings {
+		double iou_thresh = 0.3;     // Suppress a candidate overlapping a better one by more than this
+		double nested_thresh = 0.8;  // Suppress a candidate whose area is covered by a better one by more than this
+		int top_k = 4;               // Maximum number of candidates kept, 0 for no limit
+
+		cv::Scalar plate_color = cv::Scalar(255, 255, 255);
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that calculates the intersection over union of two rectangles
+	 */
+	double intersectionOverUnion(const cv::Rect& left, const cv::Rect& right);
+
+	/**
+	 * \brief Function that fills in the score of a plate candidate
+	 *
+	 * \param[in] candidate - a candidate with its contour and box set
+	 *
+	 * \param[in] image - the BGR image the candidate comes from
+	 *
+	 * \param[in] edges - the edge map of the image, as used for finding the contours
+	 *
+	 * \note The score combines rectangularity, background color match and edge density
+	 */
+	void scorePlateCandidate(PlateCandidate& candidate, const cv::Mat& image, const cv::Mat& edges, const CandidateSettings& settings);
+
+	/**
+	 * \brief Function that keeps only the best candidate for each physical plate
+	 *
+	 * \param[in] candidates - scored candidates, in any order
+	 *
+	 * \param[out] result - candidates sorted by descending score, with overlapping and nested ones removed
+	 *
+	 * \note At most settings.top_k candidates are returned
+	 */
+	std::vector<PlateCandidate> suppressNonMaximum(std::vector<PlateCandidate> candidates, const CandidateSettings& settings);
+}
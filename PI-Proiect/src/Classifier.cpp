@@ -0,0 +1,384 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Classifier.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <numeric>
+
+namespace pi {
+
+	namespace {
+		const char weights_magic[4] = { 'P', 'I', 'W', 'C' };
+		const uint32_t weights_version = 1;
+		const uint32_t max_classes = 256;
+
+		// Standardized features are clipped to this many standard deviations before quantization
+		const float input_range = 4.0f;
+
+		std::vector<int8_t> quantizeInput(const std::vector<float>& features, const std::vector<float>& mean, const std::vector<float>& inv_std) {
+			std::vector<int8_t> quantized(classifier_stride, 0);
+
+			for (int i = 0; i < classifier_features; i++) {
+				float value = (features[i] - mean[i]) * inv_std[i];
+				value = std::min(std::max(value, -input_range), input_range);
+
+				quantized[i] = (int8_t)cvRound(value * 127.0f / input_range);
+			}
+
+			return quantized;
+		}
+
+		template <typename T>
+		void writeArray(std::ofstream& file, const std::vector<T>& values) {
+			file.write((const char*)values.data(), values.size() * sizeof(T));
+		}
+
+		template <typename T>
+		bool readArray(std::ifstream& file, std::vector<T>& values, size_t count) {
+			values.resize(count);
+			return (bool)file.read((char*)values.data(), count * sizeof(T));
+		}
+	}
+
+	void LetterClassifier::Train(const std::vector<std::vector<float>>& samples, const std::vector<char>& sample_labels, const TrainSettings& settings) {
+		labels = sample_labels;
+		std::sort(labels.begin(), labels.end());
+		labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+		int classes = (int)labels.size();
+		int count = (int)samples.size();
+
+		// Standardize every feature over the training set, constant features get a unit deviation
+
+		mean.assign(classifier_features, 0.0f);
+		inv_std.assign(classifier_features, 1.0f);
+
+		for (int i = 0; i < classifier_features; i++) {
+			double sum = 0.0, sum2 = 0.0;
+
+			for (auto& sample : samples) {
+				sum += sample[i];
+				sum2 += (double)sample[i] * sample[i];
+			}
+
+			double average = sum / std::max(count, 1);
+			double deviation = std::sqrt(std::max(sum2 / std::max(count, 1) - average * average, 0.0));
+
+			mean[i] = (float)average;
+			inv_std[i] = deviation > 1e-6 ? (float)(1.0 / deviation) : 1.0f;
+		}
+
+		std::vector<std::vector<float>> inputs(count, std::vector<float>(classifier_features));
+		std::vector<int> targets(count);
+
+		for (int s = 0; s < count; s++) {
+			for (int i = 0; i < classifier_features; i++) {
+				inputs[s][i] = std::min(std::max((samples[s][i] - mean[i]) * inv_std[i], -input_range), input_range);
+			}
+
+			targets[s] = (int)(std::lower_bound(labels.begin(), labels.end(), sample_labels[s]) - labels.begin());
+		}
+
+		// Softmax regression with plain stochastic gradient descent
+
+		cv::Mat trained = cv::Mat::zeros(classes, classifier_features, CV_32F);
+		std::vector<float> trained_bias(classes, 0.0f);
+
+		std::vector<int> order(count);
+		std::iota(order.begin(), order.end(), 0);
+
+		std::vector<double> probabilities(classes);
+
+		cv::RNG rng(settings.seed);
+
+		for (int epoch = 0; epoch < settings.epochs; epoch++) {
+			for (int i = count - 1; i > 0; i--) {
+				std::swap(order[i], order[rng.uniform(0, i + 1)]);
+			}
+
+			// Decaying step size, the last epochs only fine tune
+
+			double rate = settings.learning_rate / (1.0 + 4.0 * epoch / settings.epochs);
+
+			for (int s : order) {
+				const float* input = inputs[s].data();
+
+				double highest = -std::numeric_limits<double>::infinity();
+
+				for (int c = 0; c < classes; c++) {
+					const float* row = trained.ptr<float>(c);
+					double logit = trained_bias[c];
+
+					for (int i = 0; i < classifier_features; i++) {
+						logit += row[i] * input[i];
+					}
+
+					probabilities[c] = logit;
+					highest = std::max(highest, logit);
+				}
+
+				double total = 0.0;
+
+				for (double& p : probabilities) {
+					p = std::exp(p - highest);
+					total += p;
+				}
+
+				for (int c = 0; c < classes; c++) {
+					double error = probabilities[c] / total - (c == targets[s] ? 1.0 : 0.0);
+
+					float* row = trained.ptr<float>(c);
+
+					for (int i = 0; i < classifier_features; i++) {
+						row[i] -= (float)(rate * (error * input[i] + settings.regularization * row[i]));
+					}
+
+					trained_bias[c] -= (float)(rate * error);
+				}
+			}
+		}
+
+		// One scale per class, so the largest weight of every class uses the whole int8 range
+
+		weights = cv::Mat::zeros(classes, classifier_stride, CV_8S);
+		weight_scale.assign(classes, 1.0f);
+		bias = trained_bias;
+
+		for (int c = 0; c < classes; c++) {
+			const float* row = trained.ptr<float>(c);
+			int8_t* quantized = weights.ptr<int8_t>(c);
+
+			float largest = 0.0f;
+
+			for (int i = 0; i < classifier_features; i++) {
+				largest = std::max(largest, std::abs(row[i]));
+			}
+
+			float scale = largest > 0.0f ? largest / 127.0f : 1.0f;
+
+			for (int i = 0; i < classifier_features; i++) {
+				quantized[i] = (int8_t)cvRound(row[i] / scale);
+			}
+
+			// Inputs are quantized with input_range / 127, fold that in so inference is one multiply per class
+
+			weight_scale[c] = scale * input_range / 127.0f;
+		}
+	}
+
+	bool LetterClassifier::Save(const std::string& path) const {
+		std::ofstream file(path, std::ios::binary);
+
+		if (!file.good()) {
+			return false;
+		}
+
+		uint32_t header[4] = { weights_version, (uint32_t)labels.size(), (uint32_t)classifier_features, (uint32_t)classifier_stride };
+
+		file.write(weights_magic, sizeof(weights_magic));
+		file.write((const char*)header, sizeof(header));
+
+		writeArray(file, labels);
+		writeArray(file, mean);
+		writeArray(file, inv_std);
+		writeArray(file, weight_scale);
+		writeArray(file, bias);
+
+		file.write((const char*)weights.data, weights.total());
+
+		return file.good();
+	}
+
+	bool LetterClassifier::Load(const std::string& path) {
+		*this = LetterClassifier();
+
+		std::ifstream file(path, std::ios::binary);
+
+		char magic[4];
+		uint32_t header[4];
+
+		if (!file.read(magic, sizeof(magic)) || !file.read((char*)header, sizeof(header))) {
+			return false;
+		}
+
+		// The features are tied to this build, weights made for another layout are of no use
+
+		if (!std::equal(magic, magic + 4, weights_magic) || header[0] != weights_version ||
+			header[2] != (uint32_t)classifier_features || header[3] != (uint32_t)classifier_stride)
+		{
+			return false;
+		}
+
+		// Labels are chars, a larger count only comes from a corrupt file
+
+		if (header[1] == 0 || header[1] > max_classes) {
+			return false;
+		}
+
+		int classes = (int)header[1];
+
+		LetterClassifier loaded;
+		loaded.weights = cv::Mat::zeros(classes, classifier_stride, CV_8S);
+
+		bool complete =
+			readArray(file, loaded.labels, classes) &&
+			readArray(file, loaded.mean, classifier_features) &&
+			readArray(file, loaded.inv_std, classifier_features) &&
+			readArray(file, loaded.weight_scale, classes) &&
+			readArray(file, loaded.bias, classes) &&
+			file.read((char*)loaded.weights.data, loaded.weights.total());
+
+		if (!complete) {
+			return false;
+		}
+
+		*this = std::move(loaded);
+
+		return true;
+	}
+
+	bool LetterClassifier::Empty() const {
+		return labels.empty();
+	}
+
+	int LetterClassifier::Size() const {
+		return (int)labels.size();
+	}
+
+	char LetterClassifier::Label(int index) const {
+		return labels[index];
+	}
+
+	void LetterClassifier::Classify(const std::vector<float>& features, int class_mask, pi::LetterCandidates& candidates) const {
+		std::vector<int8_t> input = quantizeInput(features, mean, inv_std);
+
+		std::vector<double> logits(Size(), -std::numeric_limits<double>::infinity());
+		double highest = -std::numeric_limits<double>::infinity();
+
+		for (int c = 0; c < Size(); c++) {
+			if (!(pi::charClass(labels[c]) & class_mask)) {
+				continue;
+			}
+
+			logits[c] = dotProductInt8(weights.ptr<int8_t>(c), input.data(), classifier_stride) * (double)weight_scale[c] + bias[c];
+			highest = std::max(highest, logits[c]);
+		}
+
+		// Negative log probabilities, normalized over the allowed classes only
+
+		double total = 0.0;
+
+		for (double logit : logits) {
+			total += std::exp(logit - highest);
+		}
+
+		double log_total = highest + std::log(total);
+
+		for (int c = 0; c < Size(); c++) {
+			if (logits[c] != -std::numeric_limits<double>::infinity()) {
+				candidates.Insert(labels[c], log_total - logits[c]);
+			}
+		}
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	std::vector<float> glyphFeatures(const pi::GlyphDescriptor& descriptor) {
+		CV_Assert(descriptor.zoning.total() == pi::zoning_dimension * pi::zoning_dimension);
+
+		std::vector<float> features(classifier_stride, 0.0f);
+		float* out = features.data();
+
+		const uint8_t* hog = descriptor.hog.ptr<uint8_t>();
+
+		for (int i = 0; i < pi::hog_length; i++) {
+			*out++ = hog[i] / 255.0f;
+		}
+
+		for (auto it = descriptor.zoning.begin<double>(); it != descriptor.zoning.end<double>(); ++it) {
+			*out++ = (float)*it;
+		}
+
+		cv::Mat thumbnail;
+		cv::resize(descriptor.intensity, thumbnail, classifier_thumbnail, 0.0, 0.0, cv::INTER_AREA);
+
+		for (auto it = thumbnail.begin<uint8_t>(); it != thumbnail.end<uint8_t>(); ++it) {
+			*out++ = *it / 255.0f;
+		}
+
+		*out++ = (float)std::log(std::max(descriptor.aspect, 1e-3));
+
+		return features;
+	}
+
+	cv::Mat augmentGlyph(const cv::Mat& glyph, cv::RNG& rng, const AugmentSettings& settings) {
+		cv::Point2f center(glyph.cols / 2.0f, glyph.rows / 2.0f);
+
+		double angle = rng.uniform(-settings.max_rotation, settings.max_rotation);
+		double scale = 1.0 + rng.uniform(-settings.max_scale, settings.max_scale);
+
+		cv::Mat transform = cv::getRotationMatrix2D(center, angle, scale);
+		transform.at<double>(0, 2) += rng.uniform(-settings.max_shift, settings.max_shift) * glyph.cols;
+		transform.at<double>(1, 2) += rng.uniform(-settings.max_shift, settings.max_shift) * glyph.rows;
+
+		// The plate background is light, fill the uncovered corners the same way
+
+		cv::Mat result;
+		cv::warpAffine(glyph, result, transform, glyph.size(), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all(255));
+
+		double sigma = rng.uniform(0.0, settings.max_blur);
+
+		if (sigma > 0.3) {
+			cv::GaussianBlur(result, result, cv::Size(), sigma);
+		}
+
+		if (settings.noise > 0.0) {
+			cv::Mat noise(result.size(), CV_16S);
+			rng.fill(noise, cv::RNG::NORMAL, 0.0, settings.noise);
+
+			cv::Mat noisy;
+			result.convertTo(noisy, CV_16S);
+			noisy += noise;
+			noisy.convertTo(result, CV_8U);
+		}
+
+		return result;
+	}
+
+	int32_t dotProductInt8(const int8_t* left, const int8_t* right, int count) {
+		int i = 0;
+		int32_t sum = 0;
+
+#if CV_SIMD
+		cv::v_int32 acc = cv::vx_setzero_s32();
+
+		const int lanes = cv::v_int8::nlanes;
+
+		for (; i <= count - lanes; i += lanes) {
+			acc = cv::v_dotprod_expand(cv::vx_load(left + i), cv::vx_load(right + i), acc);
+		}
+
+		sum = cv::v_reduce_sum(acc);
+
+		cv::vx_cleanup();
+#endif
+
+		for (; i < count; i++) {
+			sum += (int32_t)left[i] * right[i];
+		}
+
+		return sum;
+	}
+
+	ConfidenceSettings classifierConfidence() {
+		ConfidenceSettings settings;
+		settings.temperature = 1.0;
+		settings.half_distance = 1.0;
+
+		return settings;
+	}
+}
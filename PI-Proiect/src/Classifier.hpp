@@ -0,0 +1,145 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Glyph.hpp"
+#include "Hog.hpp"
+#include "Grammar.hpp"
+#include "Confidence.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Global variables                                        */
+	/*************************************************************************************************/
+
+	/*size of the coarse intensity image included in the classifier features*/
+	const cv::Size classifier_thumbnail = cv::Size(7, 10);
+
+	/*number of features per glyph: orientation histograms, zoning, thumbnail and aspect ratio*/
+	const int classifier_features = pi::hog_length + pi::zoning_dimension * pi::zoning_dimension + 7 * 10 + 1;
+	const int classifier_stride = (classifier_features + 63) / 64 * 64;
+
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*random distortions applied to the font glyphs to make training samples*/
+	struct AugmentSettings {
+		// Number of distorted copies made of every glyph, the original is always kept
+		int copies = 40;
+
+		// Maximum relative change of the size, and maximum shift as a fraction of the glyph size
+		double max_scale = 0.12;
+		double max_shift = 0.06;
+
+		// Maximum rotation in degrees
+		double max_rotation = 6.0;
+
+		// Maximum sigma of the gaussian blur, and standard deviation of the added noise in gray levels
+		double max_blur = 1.2;
+		double noise = 12.0;
+	};
+
+	/*parameters of the softmax regression training*/
+	struct TrainSettings {
+		int epochs = 60;
+		double learning_rate = 0.05;
+		double regularization = 1e-4;
+
+		uint64_t seed = 12345;
+	};
+
+	/*a linear classifier over glyph features, evaluated with int8 weights*/
+	class LetterClassifier {
+	private:
+
+		std::vector<char> labels;
+
+		// Features are standardized with the training statistics, then quantized to int8
+		std::vector<float> mean;
+		std::vector<float> inv_std;
+
+		// One row of classifier_stride int8 weights per class, padding is zero
+		cv::Mat weights;
+		std::vector<float> weight_scale;
+		std::vector<float> bias;
+
+	public:
+
+		/**
+		 * \brief Function that trains the classifier on labelled feature vectors
+		 *
+		 * \param[in] samples - feature vectors returned by pi::glyphFeatures()
+		 *
+		 * \param[in] sample_labels - the character of every sample
+		 */
+		void Train(const std::vector<std::vector<float>>& samples, const std::vector<char>& sample_labels, const TrainSettings& settings);
+
+		/**
+		 * \brief Function that writes the weights to a binary file
+		 *
+		 * \param[out] returns false if the file couldn't be written
+		 */
+		bool Save(const std::string& path) const;
+
+		/**
+		 * \brief Function that reads weights written by Save()
+		 *
+		 * \param[out] returns false if the file is missing, of another version or truncated, the classifier is left empty
+		 */
+		bool Load(const std::string& path);
+
+		bool Empty() const;
+
+		int Size() const;
+
+		char Label(int index) const;
+
+		/**
+		 * \brief Function that classifies a glyph
+		 *
+		 * \param[in] features - feature vector returned by pi::glyphFeatures()
+		 *
+		 * \param[in] class_mask - pi::CharClass mask, classes of other kinds are left out
+		 *
+		 * \param[out] candidates - the most likely characters, the distance is the negative log probability
+		 */
+		void Classify(const std::vector<float>& features, int class_mask, pi::LetterCandidates& candidates) const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that flattens a glyph descriptor into the classifier features
+	 *
+	 * \param[out] features - pi::classifier_stride floats, the padding is zero
+	 */
+	std::vector<float> glyphFeatures(const pi::GlyphDescriptor& descriptor);
+
+	/**
+	 * \brief Function that makes a randomly scaled, rotated, shifted, blurred and noisy copy of a glyph
+	 *
+	 * \param[in] glyph - grayscale glyph, dark on light
+	 */
+	cv::Mat augmentGlyph(const cv::Mat& glyph, cv::RNG& rng, const AugmentSettings& settings);
+
+	/**
+	 * \brief Function that calculates the dot product of two int8 arrays
+	 *
+	 * \note Uses the OpenCV universal intrinsics when available
+	 */
+	int32_t dotProductInt8(const int8_t* left, const int8_t* right, int count);
+
+	/**
+	 * \brief Function that returns the confidence settings matching the classifier distances
+	 *
+	 * \note The distances are negative log probabilities, a temperature of one gives back the probabilities
+	 */
+	ConfidenceSettings classifierConfidence();
+}
@@ -0,0 +1,121 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Confidence.hpp"
+
+namespace pi {
+
+	void LetterCandidates::Reset(int k) {
+		count = 0;
+		capacity = std::max(1, std::min(k, max_letter_candidates));
+	}
+
+	bool LetterCandidates::Insert(char letter, double distance) {
+		if (count == capacity && distance >= items[count - 1].distance) {
+			return false;
+		}
+
+		// A letter is kept once, with its best distance, even when several fonts have a glyph for it
+
+		for (int i = 0; i < count; i++) {
+			if (items[i].letter != letter) {
+				continue;
+			}
+
+			if (items[i].distance <= distance) {
+				return false;
+			}
+
+			std::copy(items.begin() + i + 1, items.begin() + count, items.begin() + i);
+			count--;
+			break;
+		}
+
+		// Shift the worse readings one place down, the last one falls off if the list is full
+
+		int position = std::min(count, capacity - 1);
+
+		while (position > 0 && items[position - 1].distance > distance) {
+			items[position] = items[position - 1];
+			position--;
+		}
+
+		items[position].letter = letter;
+		items[position].distance = distance;
+		items[position].score = 0.0;
+
+		count = std::min(count + 1, capacity);
+
+		return true;
+	}
+
+	double LetterCandidates::Bound() const {
+		return count < capacity ? std::numeric_limits<double>::infinity() : items[count - 1].distance;
+	}
+
+	int LetterCandidates::Size() const {
+		return count;
+	}
+
+	bool LetterCandidates::Empty() const {
+		return count == 0;
+	}
+
+	const LetterCandidate& LetterCandidates::operator[](int index) const {
+		return items[index];
+	}
+
+	LetterCandidate& LetterCandidates::operator[](int index) {
+		return items[index];
+	}
+
+	std::vector<LetterCandidate> LetterCandidates::ToVector() const {
+		return std::vector<LetterCandidate>(items.begin(), items.begin() + count);
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	double calibrateCandidates(LetterCandidates& candidates, const ConfidenceSettings& settings) {
+		if (candidates.Empty()) {
+			return 0.0;
+		}
+
+		// Subtracting the best distance keeps the exponentials in range
+
+		double best = candidates[0].distance;
+		double total = 0.0;
+
+		for (int i = 0; i < candidates.Size(); i++) {
+			candidates[i].score = std::exp(-(candidates[i].distance - best) / settings.temperature);
+			total += candidates[i].score;
+		}
+
+		for (int i = 0; i < candidates.Size(); i++) {
+			candidates[i].score /= total;
+		}
+
+		return candidateConfidence(candidates[0], settings);
+	}
+
+	double candidateConfidence(const LetterCandidate& candidate, const ConfidenceSettings& settings) {
+		double quality = settings.half_distance / (settings.half_distance + candidate.distance);
+
+		return candidate.score * quality;
+	}
+
+	double plateConfidence(const std::vector<double>& letter_confidences) {
+		if (letter_confidences.empty()) {
+			return 0.0;
+		}
+
+		double log_sum = 0.0;
+
+		for (double confidence : letter_confidences) {
+			log_sum += std::log(std::max(confidence, 1e-9));
+		}
+
+		return std::exp(log_sum / letter_confidences.size());
+	}
+}
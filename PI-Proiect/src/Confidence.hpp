@@ -0,0 +1,97 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Grammar.hpp"
+
+#include <array>
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*upper limit for the number of readings kept per letter*/
+	const int max_letter_candidates = 8;
+
+	/*the best readings of a letter, best first, in a fixed size buffer*/
+	class LetterCandidates {
+	private:
+
+		std::array<LetterCandidate, max_letter_candidates> items;
+		int count = 0;
+		int capacity = max_letter_candidates;
+
+	public:
+
+		/**
+		 * \brief Function that empties the list and sets how many readings it keeps, at most pi::max_letter_candidates
+		 */
+		void Reset(int k);
+
+		/**
+		 * \brief Function that adds a reading if it is among the best ones
+		 *
+		 * \param[out] returns false if the reading was worse than all the kept ones and the list was full
+		 *
+		 * \note A letter already in the list is only replaced if the new distance is smaller
+		 */
+		bool Insert(char letter, double distance);
+
+		/**
+		 * \brief Function that returns the distance a reading must beat to be kept, infinity while the list isn't full
+		 */
+		double Bound() const;
+
+		int Size() const;
+
+		bool Empty() const;
+
+		const LetterCandidate& operator[](int index) const;
+
+		LetterCandidate& operator[](int index);
+
+		std::vector<LetterCandidate> ToVector() const;
+	};
+
+	/*how distances are turned into confidences*/
+	struct ConfidenceSettings {
+		// Softness of the comparison between candidates, smaller means a small margin already gives a high score
+		double temperature = 0.01;
+
+		// Distance at which a letter is considered half as likely to be read right, whatever its margin
+		double half_distance = 0.05;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that fills in the normalized scores of the candidates of a letter
+	 *
+	 * \param[in] candidates - readings of a letter, best first
+	 *
+	 * \param[out] confidence - confidence in [0 ; 1] that the best reading is right
+	 *
+	 * \note Scores are a softmax over the negated distances and sum to 1, the confidence also drops
+	 *       with the absolute distance of the best reading, so a clear winner that matches badly still scores low
+	 */
+	double calibrateCandidates(LetterCandidates& candidates, const ConfidenceSettings& settings);
+
+	/**
+	 * \brief Function that returns the confidence of one calibrated candidate, as if it was the chosen reading
+	 */
+	double candidateConfidence(const LetterCandidate& candidate, const ConfidenceSettings& settings);
+
+	/**
+	 * \brief Function that combines the confidences of the letters of a plate
+	 *
+	 * \param[out] confidence - the geometric mean of the letter confidences, 0 for a plate without letters
+	 */
+	double plateConfidence(const std::vector<double>& letter_confidences);
+}
@@ -27,6 +27,10 @@ namespace pi {
 
 
 
+	const int plate_height = 90;
+
+	const cv::Size glyph_size = cv::Size(28, 40);
+
 	const cv::Mat Fx3x3 = cv::Mat_<double>(
 	{
 		-1, 0, 1,
@@ -27,6 +27,15 @@ namespace pi {
 	/*Sobel kernel for vertical changes*/
 	extern const cv::Mat Fy3x3;
 
+	/*height in pixels of a plate after perspective rectification*/
+	extern const int plate_height;
+
+	/*size that both font glyphs and segmented letters are resampled to before matching*/
+	extern const cv::Size glyph_size;
+
+	/*number of cells per side of the ink density grid from pi::getRegionFeatures(), fixes the layout of the classifier features*/
+	constexpr int zoning_dimension = 7;
+
 	/*the gradient of an image that consistd of magnitude and orientation of iamge*/
 	struct gradient{
 		cv::Mat orient;
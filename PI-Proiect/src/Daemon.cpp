@@ -0,0 +1,507 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Daemon.hpp"
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+	const char request_magic[4] = { 'P', 'I', 'R', 'Q' };
+
+	// How often the accept loop wakes up to look for a stop request, in milliseconds
+	const int stop_poll_interval = 200;
+
+	std::atomic<bool> stop_requested(false);
+
+	void request_stop(int)
+	{
+		stop_requested = true;
+	}
+
+	bool read_exact(int socket, void* buffer, size_t size)
+	{
+		char* data = (char*)buffer;
+
+		while (size > BASE_VALUE)
+		{
+			ssize_t count = recv(socket, data, size, BASE_VALUE);
+
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			data += count;
+			size -= count;
+		}
+
+		return true;
+	}
+
+	bool write_exact(int socket, const void* buffer, size_t size)
+	{
+		const char* data = (const char*)buffer;
+
+		while (size > BASE_VALUE)
+		{
+			ssize_t count = send(socket, data, size, MSG_NOSIGNAL);
+
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			data += count;
+			size -= count;
+		}
+
+		return true;
+	}
+
+	bool send_reply(int socket, const std::string& reply)
+	{
+		uint8_t length[4];
+
+		for (int i = BASE_VALUE; i < 4; i++)
+		{
+			length[i] = (uint8_t)(reply.size() >> (8 * i));
+		}
+
+		return write_exact(socket, length, sizeof(length)) && write_exact(socket, reply.data(), reply.size());
+	}
+
+	std::string error_reply(const std::string& error)
+	{
+		return "{\"ok\":false,\"error\":" + json_string(error) + "}";
+	}
+
+	/*everything a worker keeps from one request to the next*/
+	struct WorkerState
+	{
+		pi::WarpCache warp_cache;
+		DetectionSettings detection;
+
+		std::vector<uint8_t> payload;
+		cv::Mat frame;
+	};
+
+	// Decodes the payload into state.frame, the error says what was wrong with it otherwise
+	bool decode_request(const DaemonRequestHeader& header, WorkerState& state, std::string& error)
+	{
+		if (state.payload.empty())
+		{
+			error = "the request has no payload";
+			return false;
+		}
+
+		if (header.kind == (uint32_t)DaemonRequestKind::Encoded)
+		{
+			state.frame = cv::imdecode(cv::Mat(1, (int)state.payload.size(), CV_8U, state.payload.data()), cv::IMREAD_COLOR);
+
+			if (state.frame.empty())
+			{
+				error = "the image couldn't be decoded";
+				return false;
+			}
+
+			return true;
+		}
+
+		if (header.kind == (uint32_t)DaemonRequestKind::RawBGR)
+		{
+			uint64_t stride = header.stride != BASE_VALUE ? header.stride : (uint64_t)header.width * 3;
+
+			if (header.width == BASE_VALUE || header.height == BASE_VALUE || stride < (uint64_t)header.width * 3 ||
+				stride * (header.height - 1) + (uint64_t)header.width * 3 > state.payload.size())
+			{
+				error = "the frame dimensions don't match the payload";
+				return false;
+			}
+
+			// The frame only wraps the payload buffer, it stays valid until the next request of this worker
+
+			state.frame = cv::Mat((int)header.height, (int)header.width, CV_8UC3, state.payload.data(), (size_t)stride);
+
+			return true;
+		}
+
+		error = "unknown request kind " + std::to_string(header.kind);
+		return false;
+	}
+
+	// Serves the next request of a connection, false if the connection has to be closed
+	bool serve_request(int socket, const FontData& fontData, const ReadSettings& read, const DaemonSettings& settings, WorkerState& state)
+	{
+		DaemonRequestHeader header;
+
+		if (!read_exact(socket, &header, sizeof(header)))
+		{
+			return false;
+		}
+
+		if (std::memcmp(header.magic, request_magic, sizeof(request_magic)) != BASE_VALUE || header.size > settings.max_payload)
+		{
+			send_reply(socket, error_reply(header.size > settings.max_payload ? "payload too large" : "bad request header"));
+			return false;  // The stream can't be trusted past a bad header
+		}
+
+		state.payload.resize(header.size);
+
+		if (!read_exact(socket, state.payload.data(), header.size))
+		{
+			return false;
+		}
+
+		std::string reply;
+
+		try {
+			auto decode_start = std::chrono::steady_clock::now();
+
+			std::string error;
+
+			if (!decode_request(header, state, error))
+			{
+				return send_reply(socket, error_reply(error));
+			}
+
+			double decode = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decode_start).count();
+
+			FrameResult result = process_frame(fontData, state.frame, state.detection, read);
+			result.times.decode = decode;
+
+			std::ostringstream out;
+
+			out << "{\"ok\":true,\"width\":" << state.frame.cols << ",\"height\":" << state.frame.rows
+				<< ",\"plates\":" << plates_to_json(result)
+				<< ",\"ms\":{\"decode\":" << result.times.decode << ",\"detect\":" << result.times.detect
+				<< ",\"read\":" << result.times.read << "}}";
+
+			reply = out.str();
+		}
+		catch (std::exception& e) {
+			reply = error_reply(e.what());
+		}
+
+		return send_reply(socket, reply);
+	}
+
+	// Bounds how long a request may stall half way through, in either direction
+	void set_request_timeout(int socket, int seconds)
+	{
+		if (seconds <= BASE_VALUE)
+		{
+			return;
+		}
+
+		timeval timeout = {};
+		timeout.tv_sec = seconds;
+
+		setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	}
+
+	// Makes the accept loop look at the connections again
+	void wake_up(int pipe)
+	{
+		char byte = BASE_VALUE;
+
+		if (write(pipe, &byte, 1) < 0)
+		{
+			// The pipe is full, the loop is already going to wake up
+		}
+	}
+
+	// Replaces a stale socket file left by a previous run, but nothing else
+	bool remove_stale_socket(const std::string& path)
+	{
+		struct stat status;
+
+		if (lstat(path.c_str(), &status) != BASE_VALUE)
+		{
+			return errno == ENOENT;
+		}
+
+		return S_ISSOCK(status.st_mode) && unlink(path.c_str()) == BASE_VALUE;
+	}
+}
+
+bool run_daemon(const FontData& fontData, const std::string& path,
+	const DetectionSettings& detection, const ReadSettings& read, const DaemonSettings& settings)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+
+	if (path.empty() || path.size() >= sizeof(address.sun_path))
+	{
+		std::cerr << "Invalid socket path " << path << std::endl;
+		return false;
+	}
+
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, BASE_VALUE);
+
+	if (listener < 0)
+	{
+		std::cerr << "Failed to create a socket" << std::endl;
+		return false;
+	}
+
+	if (!remove_stale_socket(path))
+	{
+		std::cerr << path << " is in the way, only a socket left by a previous run is replaced" << std::endl;
+		close(listener);
+		return false;
+	}
+
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != BASE_VALUE || listen(listener, settings.backlog) != BASE_VALUE)
+	{
+		std::cerr << "Failed to listen on " << path << std::endl;
+		close(listener);
+		return false;
+	}
+
+	// Workers hand the connections back through this pipe once their request is answered
+
+	int wake[2];
+
+	if (pipe(wake) != BASE_VALUE)
+	{
+		std::cerr << "Failed to create a pipe" << std::endl;
+		close(listener);
+		unlink(path.c_str());
+		return false;
+	}
+
+	fcntl(wake[0], F_SETFL, O_NONBLOCK);
+	fcntl(wake[1], F_SETFL, O_NONBLOCK);
+
+	stop_requested = false;
+
+	std::signal(SIGINT, request_stop);
+	std::signal(SIGTERM, request_stop);
+	std::signal(SIGPIPE, SIG_IGN);
+
+	// Every worker reads its own frames, OpenCV's own threads would only compete with them
+
+	int threads = settings.threads > BASE_VALUE ? settings.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+
+	int previous_threads = cv::getNumThreads();
+	cv::setNumThreads(1);
+
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<int> connections;  // Connections with a request waiting for a worker
+	std::set<int> active;         // Connections whose request is being served
+	std::vector<int> returned;    // Connections done with their request, not watched again yet
+
+	std::vector<std::thread> workers;
+
+	for (int t = BASE_VALUE; t < threads; t++)
+	{
+		workers.emplace_back([&]()
+		{
+			WorkerState state;
+			state.detection = detection;
+			state.detection.warp_cache = &state.warp_cache;
+			state.detection.draw = false;
+
+			while (true)
+			{
+				int connection;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					available.wait(lock, [&]() { return !connections.empty() || stop_requested; });
+
+					if (connections.empty())
+					{
+						return;
+					}
+
+					connection = connections.front();
+					connections.pop_front();
+
+					active.insert(connection);
+				}
+
+				bool keep = serve_request(connection, fontData, read, settings, state);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					active.erase(connection);
+
+					if (keep)
+					{
+						returned.push_back(connection);
+					}
+				}
+
+				if (keep)
+				{
+					wake_up(wake[1]);
+				}
+				else
+				{
+					close(connection);
+				}
+			}
+		});
+	}
+
+	std::cerr << "Listening on " << path << " with " << threads << " workers" << std::endl;
+
+	// Workers only take a connection for one request, idle connections are watched here until they send the next one
+
+	std::vector<int> idle;
+
+	while (!stop_requested)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			idle.insert(idle.end(), returned.begin(), returned.end());
+			returned.clear();
+		}
+
+		std::vector<pollfd> watched = { { listener, POLLIN, BASE_VALUE }, { wake[0], POLLIN, BASE_VALUE } };
+
+		for (int connection : idle)
+		{
+			watched.push_back({ connection, POLLIN, BASE_VALUE });
+		}
+
+		if (poll(watched.data(), watched.size(), stop_poll_interval) <= BASE_VALUE)
+		{
+			continue;
+		}
+
+		if (watched[1].revents != BASE_VALUE)
+		{
+			char bytes[64];
+
+			while (::read(wake[0], bytes, sizeof(bytes)) > BASE_VALUE)
+			{
+			}
+		}
+
+		// Readable or hung up, either way a worker finds out which
+
+		std::vector<int> waiting;
+		std::vector<int> still_idle;
+
+		for (size_t i = 2; i < watched.size(); i++)
+		{
+			(watched[i].revents != BASE_VALUE ? waiting : still_idle).push_back(watched[i].fd);
+		}
+
+		idle = std::move(still_idle);
+
+		if (!waiting.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				connections.insert(connections.end(), waiting.begin(), waiting.end());
+			}
+
+			available.notify_all();
+		}
+
+		if (watched[0].revents & POLLIN)
+		{
+			int connection = accept(listener, nullptr, nullptr);
+
+			if (connection >= BASE_VALUE)
+			{
+				set_request_timeout(connection, settings.request_timeout);
+				idle.push_back(connection);
+			}
+		}
+	}
+
+	// Requests being served are answered, the rest of the connections are dropped
+
+	for (int connection : idle)
+	{
+		close(connection);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (int connection : connections)
+		{
+			close(connection);
+		}
+
+		connections.clear();
+
+		for (int connection : active)
+		{
+			shutdown(connection, SHUT_RD);
+		}
+	}
+
+	available.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	for (int connection : returned)
+	{
+		close(connection);
+	}
+
+	close(wake[0]);
+	close(wake[1]);
+	close(listener);
+	unlink(path.c_str());
+
+	cv::setNumThreads(previous_threads);
+
+	return true;
+}
+
+#else
+
+bool run_daemon(const FontData& fontData, const std::string& path,
+	const DetectionSettings& detection, const ReadSettings& read, const DaemonSettings& settings)
+{
+	std::cerr << "The daemon mode needs Unix domain sockets, it isn't available on this platform" << std::endl;
+	return false;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Pipeline.hpp"
+
+/*************************************************************************************************/
+/*                                       Defines & types                                         */
+/*************************************************************************************************/
+
+// Request kinds, the payload is either an image file as it is stored or the pixels of a decoded BGR frame
+enum class DaemonRequestKind : uint32_t
+{
+	Encoded = 0,
+	RawBGR = 1
+};
+
+/*fixed size header in front of every request, all fields little endian*/
+struct DaemonRequestHeader
+{
+	char magic[4];       // "PIRQ"
+	uint32_t kind;       // DaemonRequestKind
+	uint32_t width;      // Raw frames only, in pixels
+	uint32_t height;     // Raw frames only, in pixels
+	uint32_t stride;     // Raw frames only, in bytes, 0 for width * 3
+	uint32_t size;       // Bytes of payload following the header
+};
+
+struct DaemonSettings
+{
+	// Worker threads serving the connections, 0 for one per hardware thread
+	int threads = 0;
+
+	// Requests with a larger payload are refused and their connection closed
+	uint32_t max_payload = 64u << 20;
+
+	// Connections waiting to be accepted
+	int backlog = 16;
+
+	// Seconds a request may stall half way through before its connection is closed, 0 for no limit
+	int request_timeout = 10;
+};
+
+/**************************************************************************************************/
+/*                                     Public Functions                                          */
+/**************************************************************************************************/
+
+/**
+ * \brief Function that serves plate readings over a Unix domain socket until SIGINT or SIGTERM
+ *
+ * \param[in] path - path of the socket, a socket left there by a previous run is replaced
+ *
+ * \param[out] returns false if the socket couldn't be created, or something other than a socket is in the way
+ *
+ * \note A connection sends any number of requests, each a DaemonRequestHeader and its payload, one after the other
+ *       Every reply is a 32 bit little endian length followed by a JSON object with "ok", "plates" and "ms",
+ *       or "ok" set to false and "error" for a request that couldn't be read
+ *       Requests are served concurrently by a pool of workers, each keeping its own scratch state between requests
+ *       A worker only holds a connection for one request, so idle connections don't keep it from the others
+ */
+bool run_daemon(const FontData& fontData, const std::string& path,
+	const DetectionSettings& detection, const ReadSettings& read, const DaemonSettings& settings);
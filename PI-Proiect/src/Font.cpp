@@ -0,0 +1,189 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Font.hpp"
+
+namespace pi {
+
+	void FontRegistry::Add(const FontSource& source) {
+		auto entry = std::make_unique<Entry>();
+		entry->source = source;
+
+		entries.push_back(std::move(entry));
+	}
+
+	void FontRegistry::Map(const std::string& key, const std::string& names) {
+		std::vector<std::string>& fonts = mapping[key];
+		fonts.clear();
+
+		std::stringstream stream(names);
+		std::string name;
+
+		while (std::getline(stream, name, ',')) {
+			if (!name.empty()) {
+				fonts.push_back(name);
+			}
+		}
+	}
+
+	bool FontRegistry::Has(const std::string& name) const {
+		return std::any_of(entries.begin(), entries.end(), [&](const std::unique_ptr<Entry>& entry) { return entry->source.name == name; });
+	}
+
+	bool FontRegistry::Mapped(const std::string& key) const {
+		auto it = mapping.find(key);
+
+		return it != mapping.end() && !it->second.empty();
+	}
+
+	const Font* FontRegistry::Get(const std::string& name) const {
+		for (auto& entry : entries) {
+			if (entry->source.name != name) {
+				continue;
+			}
+
+			// Other threads asking for the same font wait here until it is loaded
+
+			std::call_once(entry->once, [&]() {
+				entry->loaded = pi::loadFont(entry->source, entry->font);
+
+				if (!entry->loaded) {
+					std::cout << "Failed to load font " << name << std::endl;
+				}
+			});
+
+			return entry->loaded ? &entry->font : nullptr;
+		}
+
+		return nullptr;
+	}
+
+	std::vector<const Font*> FontRegistry::Fonts(const std::string& key) const {
+		std::vector<const Font*> result;
+
+		auto it = mapping.find(key);
+
+		if (it == mapping.end()) {
+			return result;
+		}
+
+		for (auto& name : it->second) {
+			if (const Font* font = Get(name)) {
+				result.push_back(font);
+			}
+		}
+
+		return result;
+	}
+
+	bool FontRegistry::Load(const std::string& path) {
+		std::ifstream file(path);
+
+		if (!file.good()) {
+			std::cout << "Failed to open file " << path << std::endl;
+			return false;
+		}
+
+		bool valid = true;
+
+		std::string line;
+		int number = 0;
+
+		while (std::getline(file, line)) {
+			number++;
+
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream stream(line);
+			std::string kind;
+
+			if (!(stream >> kind)) {
+				continue;  // Empty or comment only
+			}
+
+			if (kind == "font") {
+				FontSource source;
+
+				if (stream >> source.name >> source.sample_path >> source.regions_path) {
+					stream >> source.pack_path;
+					Add(source);
+					continue;
+				}
+			}
+			else if (kind == "map") {
+				std::string key, names;
+
+				if (stream >> key >> names) {
+					Map(key, names);
+					continue;
+				}
+			}
+
+			std::cout << path << ":" << number << ": malformed line \"" << line << "\"" << std::endl;
+			valid = false;
+		}
+
+		return valid;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	bool decodeFont(const std::string& sample_path, const std::string& regions_path, Font& font) {
+		font.sample = cv::imread(sample_path, cv::IMREAD_GRAYSCALE);
+		font.regions = pi::loadLetterRegions(regions_path);
+
+		if (font.sample.empty() || font.regions.empty()) {
+			return false;
+		}
+
+		// Templates are resampled to the glyph size and described once, so matching never has to rescale them
+
+		font.glyphs.clear();
+
+		cv::Rect bounds(0, 0, font.sample.cols, font.sample.rows);
+
+		for (auto& pair : font.regions) {
+			if ((pair.second.rect & bounds) != pair.second.rect) {
+				std::cout << "Glyph " << pair.first << " of " << regions_path << " is outside of " << sample_path << std::endl;
+				return false;
+			}
+
+			font.glyphs[pair.first] = pi::describeGlyph(cv::Mat(font.sample, pair.second.rect));
+		}
+
+		font.bank.Build(font.glyphs);
+		font.metrics = pi::fontMetrics(font.regions);
+
+		return true;
+	}
+
+	bool openFontPack(const std::string& path, Font& font) {
+		auto pack = std::make_shared<pi::FontPack>();
+
+		if (!pack->Open(path)) {
+			return false;
+		}
+
+		font.sample = cv::Mat();
+		font.regions.clear();
+		font.glyphs.clear();
+
+		font.bank = pack->Bank();
+		font.metrics = pack->Metrics();
+		font.pack = pack;
+
+		return true;
+	}
+
+	bool loadFont(const FontSource& source, Font& font) {
+		font.name = source.name;
+
+		if (!source.pack_path.empty() && openFontPack(source.pack_path, font)) {
+			return true;
+		}
+
+		return decodeFont(source.sample_path, source.regions_path, font);
+	}
+}
@@ -0,0 +1,140 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Glyph.hpp"
+#include "TemplateBank.hpp"
+#include "FontPack.hpp"
+#include "Regions.hpp"
+
+#include <mutex>
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	// Mapping key of the fonts read on plates whose country and format have none of their own
+	const char* const default_font_key = "default";
+
+	/*a plate font ready for matching*/
+	struct Font {
+		std::string name;
+
+		// Sample, regions and glyphs stay empty when the font comes from a pack or is embedded
+
+		cv::Mat sample;
+		std::unordered_map<char, pi::LetterRegion> regions;
+		std::unordered_map<char, pi::GlyphDescriptor> glyphs;
+
+		pi::TemplateBank bank;
+
+		// Proportions of the glyphs, invalid when the regions file has no metrics
+		pi::FontMetrics metrics;
+
+		// Keeps the mapping alive while the bank points into it
+		std::shared_ptr<pi::FontPack> pack;
+	};
+
+	/*where a font is loaded from, the pack is tried first when given*/
+	struct FontSource {
+		std::string name;
+		std::string sample_path;
+		std::string regions_path;
+		std::string pack_path;
+	};
+
+	/*fonts loaded on first use, and which of them are read on each plate format or country*/
+	class FontRegistry {
+	private:
+
+		struct Entry {
+			FontSource source;
+			std::once_flag once;
+			Font font;
+			bool loaded = false;
+		};
+
+		// Entries never move, so the fonts handed out stay valid
+		std::vector<std::unique_ptr<Entry>> entries;
+
+		std::unordered_map<std::string, std::vector<std::string>> mapping;
+
+	public:
+
+		void Add(const FontSource& source);
+
+		/**
+		 * \brief Function that sets the fonts read on plates of a format or country
+		 *
+		 * \param[in] key - plate format (EU, US, MOTO) or grammar name (RO, DE)
+		 *
+		 * \param[in] names - comma separated font names, such as "Mittelschrift,FE"
+		 */
+		void Map(const std::string& key, const std::string& names);
+
+		/**
+		 * \brief Function that tells whether a font of this name was added, without loading it
+		 */
+		bool Has(const std::string& name) const;
+
+		/**
+		 * \brief Function that tells whether any fonts are mapped to a plate format or country
+		 */
+		bool Mapped(const std::string& key) const;
+
+		/**
+		 * \brief Function that returns a font, loading it and computing its features on the first call
+		 *
+		 * \param[out] returns null if the font is unknown or failed to load
+		 *
+		 * \note Safe to call from several threads, a font is only ever loaded once
+		 */
+		const Font* Get(const std::string& name) const;
+
+		/**
+		 * \brief Function that returns the fonts mapped to a plate format or country
+		 *
+		 * \param[out] result - the fonts that loaded, empty if nothing is mapped to the key
+		 */
+		std::vector<const Font*> Fonts(const std::string& key) const;
+
+		/**
+		 * \brief Function that reads the fonts and the mapping from a text file
+		 *
+		 * \note One entry per line, '#' starts a comment:
+		 *       font <name> <sample image> <regions file> [font pack]
+		 *       map <format or country> <comma separated font names>
+		 *
+		 * \param[out] returns false if the file couldn't be opened or a line is malformed, the valid lines are kept
+		 */
+		bool Load(const std::string& path);
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that decodes a font sample and describes every glyph in its regions file
+	 *
+	 * \param[out] returns false if the sample or the regions couldn't be read
+	 */
+	bool decodeFont(const std::string& sample_path, const std::string& regions_path, Font& font);
+
+	/**
+	 * \brief Function that maps a font pack written by pi::writeFontPack()
+	 *
+	 * \param[out] returns false if the pack couldn't be opened, font is left as it was
+	 */
+	bool openFontPack(const std::string& path, Font& font);
+
+	/**
+	 * \brief Function that loads a font from its pack if it has a usable one, from its sample otherwise
+	 */
+	bool loadFont(const FontSource& source, Font& font);
+}
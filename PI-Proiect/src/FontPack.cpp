@@ -0,0 +1,278 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "FontPack.hpp"
+
+#include <cstring>
+
+namespace pi {
+
+	namespace {
+		const char font_pack_magic[4] = { 'P', 'I', 'F', 'P' };
+
+		// Sections start on cache line boundaries, so the SIMD loads over the mapped rows stay aligned
+		const uint64_t section_alignment = 64;
+
+		uint64_t alignSection(uint64_t offset) {
+			return (offset + section_alignment - 1) / section_alignment * section_alignment;
+		}
+
+		void writeSection(std::ofstream& file, uint64_t offset, const void* data, size_t size) {
+			// Zero padding up to the start of the section
+
+			static const char padding[section_alignment] = { 0 };
+
+			uint64_t position = (uint64_t)file.tellp();
+			file.write(padding, (std::streamsize)(offset - position));
+			file.write((const char*)data, (std::streamsize)size);
+		}
+
+		template <typename T>
+		void writeArray(std::ofstream& file, const char* type, const char* name, const std::vector<T>& values, const char* suffix) {
+			// Hexadecimal floats are exact and always valid literals, 0f wouldn't be
+
+			if (std::is_floating_point<T>::value) {
+				file << std::hexfloat;
+			}
+
+			file << "\talignas(64) constexpr " << type << " " << name << "[" << values.size() << "] = {";
+
+			for (size_t i = 0; i < values.size(); i++) {
+				file << (i % 16 == 0 ? "\n\t\t" : " ") << +values[i] << suffix << ",";
+			}
+
+			file << "\n\t};\n\n" << std::defaultfloat;
+		}
+
+		bool sectionFits(uint64_t offset, uint64_t size, uint64_t total) {
+			return offset % section_alignment == 0 && offset <= total && size <= total - offset;
+		}
+	}
+
+	bool FontPack::Open(const std::string& path) {
+		header = nullptr;
+		bank = TemplateBank();
+
+		if (!file.Open(path) || file.Size() < sizeof(FontPackHeader)) {
+			return false;
+		}
+
+		const FontPackHeader* candidate = (const FontPackHeader*)file.Data();
+
+		bool compatible =
+			std::equal(candidate->magic, candidate->magic + 4, font_pack_magic) &&
+			candidate->version == font_pack_version &&
+			candidate->glyph_width == (uint32_t)pi::glyph_size.width &&
+			candidate->glyph_height == (uint32_t)pi::glyph_size.height &&
+			candidate->hog_stride == (uint32_t)pi::hog_stride &&
+			candidate->total_size == file.Size();
+
+		if (!compatible) {
+			file.Close();
+			return false;
+		}
+
+		uint64_t count = candidate->glyph_count;
+		uint64_t total = candidate->total_size;
+		uint64_t pixels = (uint64_t)candidate->glyph_width * candidate->glyph_height;
+
+		bool complete =
+			sectionFits(candidate->labels_offset, count, total) &&
+			sectionFits(candidate->aspects_offset, count * sizeof(double), total) &&
+			sectionFits(candidate->bitmaps_offset, count * pixels, total) &&
+			sectionFits(candidate->data_offset, (uint64_t)TemplatePlane::Count * count * candidate->stride * sizeof(float), total) &&
+			sectionFits(candidate->zoning_offset, count * candidate->zoning_stride * sizeof(float), total) &&
+			sectionFits(candidate->hog_offset, count * candidate->hog_stride, total);
+
+		if (!complete) {
+			file.Close();
+			return false;
+		}
+
+		const uint8_t* base = file.Data();
+
+		std::vector<char> labels(base + candidate->labels_offset, base + candidate->labels_offset + count);
+
+		std::vector<double> aspects(count);
+		std::memcpy(aspects.data(), base + candidate->aspects_offset, count * sizeof(double));
+
+		bool wrapped = bank.Wrap(labels, aspects, (int)candidate->stride, (int)candidate->zoning_stride,
+			(const float*)(base + candidate->data_offset),
+			(const float*)(base + candidate->zoning_offset),
+			base + candidate->hog_offset);
+
+		if (!wrapped) {
+			file.Close();
+			return false;
+		}
+
+		header = candidate;
+
+		return true;
+	}
+
+	const TemplateBank& FontPack::Bank() const {
+		return bank;
+	}
+
+	cv::Mat FontPack::Bitmap(int index) const {
+		const uint8_t* bitmaps = file.Data() + header->bitmaps_offset;
+		size_t pixels = (size_t)header->glyph_width * header->glyph_height;
+
+		return cv::Mat((int)header->glyph_height, (int)header->glyph_width, CV_8U, (void*)(bitmaps + index * pixels));
+	}
+
+	FontMetrics FontPack::Metrics() const {
+		FontMetrics metrics;
+		metrics.min_width = header->min_width;
+		metrics.max_width = header->max_width;
+		metrics.advance = header->advance;
+
+		return metrics;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	bool writeFontPack(const std::string& path, const std::unordered_map<char, pi::GlyphDescriptor>& glyphs, const TemplateBank& bank,
+		const FontMetrics& metrics)
+	{
+		uint64_t count = (uint64_t)bank.Size();
+		uint64_t pixels = (uint64_t)pi::glyph_size.area();
+		uint64_t planes = (uint64_t)TemplatePlane::Count;
+
+		std::vector<char> labels;
+		std::vector<double> aspects;
+		std::vector<uint8_t> bitmaps;
+
+		// Gather the sections in bank order, the bank rows are already contiguous
+
+		std::vector<float> data;
+		std::vector<float> zoning;
+		std::vector<uint8_t> hog;
+
+		for (uint64_t plane = 0; plane < planes; plane++) {
+			for (int index = 0; index < (int)count; index++) {
+				const float* row = bank.Plane(index, (TemplatePlane)plane);
+				data.insert(data.end(), row, row + bank.Stride());
+			}
+		}
+
+		for (int index = 0; index < (int)count; index++) {
+			char label = bank.Label(index);
+
+			labels.push_back(label);
+			aspects.push_back(bank.Aspect(index));
+
+			const cv::Mat& intensity = glyphs.at(label).intensity;
+			CV_Assert(intensity.isContinuous() && intensity.total() == pixels);
+			bitmaps.insert(bitmaps.end(), intensity.data, intensity.data + pixels);
+
+			zoning.insert(zoning.end(), bank.Zoning(index), bank.Zoning(index) + bank.ZoningStride());
+			hog.insert(hog.end(), bank.Histograms(index), bank.Histograms(index) + pi::hog_stride);
+		}
+
+		FontPackHeader header = {};
+
+		std::copy(font_pack_magic, font_pack_magic + 4, header.magic);
+		header.version = font_pack_version;
+		header.glyph_count = (uint32_t)count;
+		header.glyph_width = (uint32_t)pi::glyph_size.width;
+		header.glyph_height = (uint32_t)pi::glyph_size.height;
+		header.stride = (uint32_t)bank.Stride();
+		header.zoning_stride = (uint32_t)bank.ZoningStride();
+		header.hog_stride = (uint32_t)pi::hog_stride;
+
+		header.min_width = metrics.min_width;
+		header.max_width = metrics.max_width;
+		header.advance = metrics.advance;
+
+		header.labels_offset = alignSection(sizeof(FontPackHeader));
+		header.aspects_offset = alignSection(header.labels_offset + labels.size());
+		header.bitmaps_offset = alignSection(header.aspects_offset + aspects.size() * sizeof(double));
+		header.data_offset = alignSection(header.bitmaps_offset + bitmaps.size());
+		header.zoning_offset = alignSection(header.data_offset + data.size() * sizeof(float));
+		header.hog_offset = alignSection(header.zoning_offset + zoning.size() * sizeof(float));
+		header.total_size = header.hog_offset + hog.size();
+
+		std::ofstream file(path, std::ios::binary);
+
+		if (!file.good()) {
+			return false;
+		}
+
+		file.write((const char*)&header, sizeof(header));
+
+		writeSection(file, header.labels_offset, labels.data(), labels.size());
+		writeSection(file, header.aspects_offset, aspects.data(), aspects.size() * sizeof(double));
+		writeSection(file, header.bitmaps_offset, bitmaps.data(), bitmaps.size());
+		writeSection(file, header.data_offset, data.data(), data.size() * sizeof(float));
+		writeSection(file, header.zoning_offset, zoning.data(), zoning.size() * sizeof(float));
+		writeSection(file, header.hog_offset, hog.data(), hog.size());
+
+		return file.good();
+	}
+
+	bool writeFontHeader(const std::string& path, const TemplateBank& bank, const FontMetrics& metrics) {
+		int count = bank.Size();
+
+		std::vector<int> labels;
+		std::vector<double> aspects;
+		std::vector<float> data;
+		std::vector<float> zoning;
+		std::vector<int> hog;
+
+		for (int plane = 0; plane < (int)TemplatePlane::Count; plane++) {
+			for (int index = 0; index < count; index++) {
+				const float* row = bank.Plane(index, (TemplatePlane)plane);
+				data.insert(data.end(), row, row + bank.Stride());
+			}
+		}
+
+		for (int index = 0; index < count; index++) {
+			labels.push_back(bank.Label(index));
+			aspects.push_back(bank.Aspect(index));
+
+			zoning.insert(zoning.end(), bank.Zoning(index), bank.Zoning(index) + bank.ZoningStride());
+			hog.insert(hog.end(), bank.Histograms(index), bank.Histograms(index) + pi::hog_stride);
+		}
+
+		std::ofstream file(path);
+
+		if (!file.good()) {
+			return false;
+		}
+
+		file << "/* Generated by --generate-font-header, do not edit */\n\n";
+		file << "#pragma once\n\n";
+		file << "#include <cstdint>\n\n";
+		file << "namespace pi {\n";
+		file << "namespace embedded_font {\n\n";
+
+		file << "\tconstexpr uint32_t version = " << font_pack_version << ";\n\n";
+		file << "\tconstexpr int glyph_count = " << count << ";\n";
+		file << "\tconstexpr int glyph_width = " << pi::glyph_size.width << ";\n";
+		file << "\tconstexpr int glyph_height = " << pi::glyph_size.height << ";\n\n";
+		file << "\tconstexpr int stride = " << bank.Stride() << ";\n";
+		file << "\tconstexpr int zoning_stride = " << bank.ZoningStride() << ";\n";
+		file << "\tconstexpr int hog_stride = " << pi::hog_stride << ";\n\n";
+
+		file << std::hexfloat;
+		file << "\tconstexpr double min_width = " << metrics.min_width << ";\n";
+		file << "\tconstexpr double max_width = " << metrics.max_width << ";\n";
+		file << "\tconstexpr double advance = " << metrics.advance << ";\n\n";
+		file << std::defaultfloat;
+
+		writeArray(file, "char", "labels", labels, "");
+		writeArray(file, "double", "aspects", aspects, "");
+		writeArray(file, "float", "data", data, "f");
+		writeArray(file, "float", "zoning", zoning, "f");
+		writeArray(file, "uint8_t", "hog", hog, "");
+
+		file << "}\n";
+		file << "}\n";
+
+		return file.good();
+	}
+}
@@ -0,0 +1,114 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Glyph.hpp"
+#include "TemplateBank.hpp"
+#include "MappedFile.hpp"
+#include "Regions.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*current version of the font pack layout, packs of any other version are rejected*/
+	const uint32_t font_pack_version = 2;
+
+	/*the start of a font pack, every offset is from the start of the file and a multiple of 64*/
+	struct FontPackHeader {
+		char magic[4];
+		uint32_t version;
+
+		uint32_t glyph_count;
+		uint32_t glyph_width;
+		uint32_t glyph_height;
+
+		// Floats per template plane, floats per zoning row and bytes per histogram row
+		uint32_t stride;
+		uint32_t zoning_stride;
+		uint32_t hog_stride;
+
+		uint64_t labels_offset;     // glyph_count chars
+		uint64_t aspects_offset;    // glyph_count doubles
+		uint64_t bitmaps_offset;    // glyph_count glyph_width x glyph_height CV_8U bitmaps
+		uint64_t data_offset;       // Template planes, as in pi::TemplateBank
+		uint64_t zoning_offset;     // glyph_count rows of zoning_stride floats
+		uint64_t hog_offset;        // glyph_count rows of hog_stride bytes
+
+		// pi::FontMetrics of the font, all zero when its regions had no metrics
+		double min_width;
+		double max_width;
+		double advance;
+
+		uint64_t total_size;
+	};
+
+	/*a compiled font mapped into memory, the template bank points straight into the mapped pages*/
+	class FontPack {
+	private:
+
+		MappedFile file;
+		TemplateBank bank;
+
+		const FontPackHeader* header = nullptr;
+
+	public:
+
+		/**
+		 * \brief Function that maps a pack written by pi::writeFontPack()
+		 *
+		 * \param[out] returns false if the file is missing, truncated, of another version or built for other glyph dimensions
+		 *
+		 * \note Nothing is decoded or copied, opening costs a system call and a few checks of the header
+		 */
+		bool Open(const std::string& path);
+
+		/**
+		 * \brief Function that returns the bank over the mapped templates, only valid while the pack is open
+		 */
+		const TemplateBank& Bank() const;
+
+		/**
+		 * \brief Function that returns the resampled bitmap of a glyph, wrapping the mapped memory
+		 */
+		cv::Mat Bitmap(int index) const;
+
+		FontMetrics Metrics() const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that writes a font pack with the glyph bitmaps and all precomputed features
+	 *
+	 * \param[in] glyphs - descriptors of the font glyphs
+	 *
+	 * \param[in] bank - template bank built from the same glyphs
+	 *
+	 * \param[in] metrics - proportions of the font, kept for the letter segmentation
+	 *
+	 * \param[out] returns false if the file couldn't be written
+	 *
+	 * \note The pack is written in the byte order of the machine, little endian on every target we build for
+	 */
+	bool writeFontPack(const std::string& path, const std::unordered_map<char, pi::GlyphDescriptor>& glyphs, const TemplateBank& bank,
+		const FontMetrics& metrics);
+
+	/**
+	 * \brief Function that writes a C++ header with the compiled font as constexpr arrays
+	 *
+	 * \param[in] path - the header to write, included by Main.cpp when PI_EMBEDDED_FONT is defined
+	 *
+	 * \param[out] returns false if the file couldn't be written
+	 *
+	 * \note The arrays are laid out like the sections of a font pack, so the bank wraps them the same way
+	 */
+	bool writeFontHeader(const std::string& path, const TemplateBank& bank, const FontMetrics& metrics);
+}
@@ -0,0 +1,36 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Glyph.hpp"
+#include "Gradient.hpp"
+#include "Helper.hpp"
+#include "Hog.hpp"
+
+namespace pi {
+
+	GlyphDescriptor describeGlyph(const cv::Mat& letter) {
+		GlyphDescriptor descriptor;
+
+		cv::resize(letter, descriptor.intensity, pi::glyph_size, 0.0, 0.0, cv::INTER_AREA);
+
+		descriptor.grad = pi::contour_gradient(descriptor.intensity);
+		descriptor.zoning = pi::getRegionFeatures(descriptor.intensity, pi::zoning_dimension);
+		descriptor.hog = pi::computeOrientationHistograms(descriptor.grad);
+
+		descriptor.aspect = letter.rows > 0 ? (double)letter.cols / letter.rows : 1.0;
+
+		return descriptor;
+	}
+
+	GlyphDistance compareGlyphs(const GlyphDescriptor& ref, const GlyphDescriptor& smpl) {
+		GlyphDistance distance;
+
+		distance.value = powf(1.0f / 255.0f, 2.0f) * pi::getImageDistance(ref.intensity, smpl.intensity);
+		distance.magnitude = powf(1.0f / 255.0f, 2.0f) * pi::getImageDistance(ref.grad.magnit, smpl.grad.magnit);
+		distance.angle = pi::normalizedHistogramDistance(ref.hog.ptr<uint8_t>(), smpl.hog.ptr<uint8_t>());
+
+		distance.total = distance.value * 0.6 + distance.magnitude * 0.25 + distance.angle * 0.5;
+
+		return distance;
+	}
+}
@@ -0,0 +1,57 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Constants.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*every feature used for matching a letter, computed once per glyph*/
+	struct GlyphDescriptor {
+		cv::Mat intensity;     // Resampled to pi::glyph_size, CV_8UC1
+		pi::gradient grad;     // Magnitude and orientation of the resampled glyph, CV_64F
+		cv::Mat zoning;        // Ink density grid of pi::zoning_dimension x pi::zoning_dimension, CV_64F
+		cv::Mat hog;           // Orientation histograms from pi::computeOrientationHistograms(), CV_8U
+
+		double aspect = 1.0;   // Width / height of the letter before resampling
+	};
+
+	/*distances between two glyph descriptors, normalized per feature*/
+	struct GlyphDistance {
+		double value = 0.0;
+		double magnitude = 0.0;
+		double angle = 0.0;
+		double total = 0.0;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that extracts all matching features of a grayscale letter
+	 *
+	 * \param[in] letter - grayscale image of the letter, of any size
+	 *
+	 * \param[out] descriptor - the features of the letter resampled to pi::glyph_size
+	 */
+	GlyphDescriptor describeGlyph(const cv::Mat& letter);
+
+	/**
+	 * \brief Function that compares two glyph descriptors
+	 *
+	 * \param[in] ref - descriptor of the font glyph
+	 *
+	 * \param[in] smpl - descriptor of the unknown letter
+	 *
+	 * \note No features are computed here, only distances between the precomputed ones
+	 */
+	GlyphDistance compareGlyphs(const GlyphDescriptor& ref, const GlyphDescriptor& smpl);
+}
@@ -0,0 +1,210 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Grammar.hpp"
+
+namespace pi {
+
+	namespace {
+		// Stops silly patterns like A{1,20} A{1,20} A{1,20} from expanding forever
+		const size_t max_sequences = 4096;
+
+		int sequenceClass(char symbol) {
+			switch (symbol) {
+				case 'L': return CharLetter;
+				case 'D': return CharDigit;
+				default: return CharAny;
+			}
+		}
+
+		void expandPattern(const std::string& pattern, std::vector<std::string>& sequences) {
+			std::vector<std::string> partial = { "" };
+
+			size_t i = 0;
+
+			while (i < pattern.size()) {
+				char symbol = pattern[i++];
+
+				if (isspace((unsigned char)symbol)) {
+					continue;
+				}
+
+				if (symbol != 'L' && symbol != 'D' && symbol != 'A') {
+					throw std::runtime_error("Unknown symbol in plate pattern: " + pattern);
+				}
+
+				int min_count = 1, max_count = 1;
+
+				if (i < pattern.size() && pattern[i] == '{') {
+					size_t close = pattern.find('}', i);
+
+					if (close == std::string::npos) {
+						throw std::runtime_error("Unclosed repetition in plate pattern: " + pattern);
+					}
+
+					std::string range = pattern.substr(i + 1, close - i - 1);
+					size_t comma = range.find(',');
+
+					min_count = std::stoi(range.substr(0, comma));
+					max_count = comma == std::string::npos ? min_count : std::stoi(range.substr(comma + 1));
+
+					if (min_count < 0 || max_count < min_count) {
+						throw std::runtime_error("Bad repetition in plate pattern: " + pattern);
+					}
+
+					i = close + 1;
+				}
+
+				std::vector<std::string> next;
+
+				for (auto& prefix : partial) {
+					for (int count = min_count; count <= max_count; count++) {
+						next.push_back(prefix + std::string(count, symbol));
+
+						if (next.size() > max_sequences) {
+							throw std::runtime_error("Plate pattern expands to too many sequences: " + pattern);
+						}
+					}
+				}
+
+				partial = std::move(next);
+			}
+
+			sequences.insert(sequences.end(), partial.begin(), partial.end());
+		}
+	}
+
+	PlateGrammar::PlateGrammar() {}
+
+	PlateGrammar::PlateGrammar(const std::string& name, const std::vector<std::string>& patterns) : name(name) {
+		for (auto& pattern : patterns) {
+			expandPattern(pattern, sequences);
+		}
+
+		std::sort(sequences.begin(), sequences.end());
+		sequences.erase(std::unique(sequences.begin(), sequences.end()), sequences.end());
+	}
+
+	const std::string& PlateGrammar::Name() const {
+		return name;
+	}
+
+	bool PlateGrammar::Empty() const {
+		return sequences.empty();
+	}
+
+	std::vector<std::string> PlateGrammar::Sequences(int length) const {
+		std::vector<std::string> result;
+
+		for (auto& sequence : sequences) {
+			if ((int)sequence.size() == length) {
+				result.push_back(sequence);
+			}
+		}
+
+		return result;
+	}
+
+	std::vector<int> PlateGrammar::PositionMasks(int length) const {
+		std::vector<std::string> matching = Sequences(length);
+
+		if (matching.empty()) {
+			return std::vector<int>(length, CharAny);
+		}
+
+		std::vector<int> masks(length, CharNone);
+
+		for (auto& sequence : matching) {
+			for (int i = 0; i < length; i++) {
+				masks[i] |= sequenceClass(sequence[i]);
+			}
+		}
+
+		return masks;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	int charClass(char letter) {
+		if (letter >= 'A' && letter <= 'Z') {
+			return CharLetter;
+		}
+
+		if (letter >= '0' && letter <= '9') {
+			return CharDigit;
+		}
+
+		return CharNone;
+	}
+
+	const PlateGrammar* findPlateGrammar(const std::string& name) {
+		static const std::map<std::string, PlateGrammar> grammars = {
+			// B 12 ABC, B 123 ABC, CJ 12 XYZ, plus the temporary / state plates
+			{ "RO", PlateGrammar("RO", { "L{1,2} D{2,3} L{3}", "L{1,2} D{6}" }) },
+
+			// Area code, one or two letters, up to four digits (the umlaut areas read as plain letters)
+			{ "DE", PlateGrammar("DE", { "L{1,3} L{1,2} D{1,4}" }) },
+		};
+
+		auto it = grammars.find(name);
+
+		return it != grammars.end() ? &it->second : nullptr;
+	}
+
+	std::string decodePlate(const std::vector<std::vector<LetterCandidate>>& positions, const PlateGrammar& grammar, double* cost) {
+		int length = (int)positions.size();
+
+		std::string best_text;
+		double best_cost = std::numeric_limits<double>::infinity();
+
+		for (auto& sequence : grammar.Sequences(length)) {
+			std::string text(length, '?');
+			double total = 0.0;
+
+			for (int i = 0; i < length && total < best_cost; i++) {
+				int mask = sequenceClass(sequence[i]);
+				bool found = false;
+
+				for (auto& candidate : positions[i]) {
+					if (charClass(candidate.letter) & mask) {
+						text[i] = candidate.letter;
+						total += candidate.distance;
+						found = true;
+						break;
+					}
+				}
+
+				if (!found) {
+					total = std::numeric_limits<double>::infinity();
+				}
+			}
+
+			if (total < best_cost) {
+				best_cost = total;
+				best_text = text;
+			}
+		}
+
+		if (best_text.empty()) {
+			// Nothing fits, read every position on its own
+
+			best_text = std::string(length, '?');
+			best_cost = 0.0;
+
+			for (int i = 0; i < length; i++) {
+				if (!positions[i].empty()) {
+					best_text[i] = positions[i][0].letter;
+					best_cost += positions[i][0].distance;
+				}
+			}
+		}
+
+		if (cost != nullptr) {
+			*cost = best_cost;
+		}
+
+		return best_text;
+	}
+}
@@ -0,0 +1,97 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*character classes used by the plate grammars, as bit masks*/
+	enum CharClass {
+		CharNone = 0,
+		CharLetter = 1,
+		CharDigit = 2,
+		CharAny = CharLetter | CharDigit
+	};
+
+	/*a possible reading of a letter and its distance to the font glyph*/
+	struct LetterCandidate {
+		char letter = '?';
+		double distance = 0.0;
+		double score = 0.0;  // Normalized over the candidates of the letter, see pi::calibrateCandidates()
+	};
+
+	/*the allowed layouts of the plates of one country*/
+	class PlateGrammar {
+	private:
+
+		std::string name;
+
+		// Every pattern expanded to fixed length sequences of 'L' (letter), 'D' (digit) or 'A' (any)
+		std::vector<std::string> sequences;
+
+	public:
+
+		PlateGrammar();
+
+		/**
+		 * \brief Function that builds a grammar from a list of patterns
+		 *
+		 * \param[in] patterns - sequences of L (letter), D (digit) or A (any), each optionally followed by {n} or {n,m}
+		 *
+		 * \note For example "L{1,2} D{2,3} L{3}" accepts both B 123 ABC and CJ 12 XYZ, spaces are ignored
+		 */
+		PlateGrammar(const std::string& name, const std::vector<std::string>& patterns);
+
+		const std::string& Name() const;
+
+		bool Empty() const;
+
+		/**
+		 * \brief Function that returns the expanded sequences with the given number of characters
+		 */
+		std::vector<std::string> Sequences(int length) const;
+
+		/**
+		 * \brief Function that returns which character classes are possible at every position
+		 *
+		 * \param[out] masks - one pi::CharClass mask per position, all pi::CharAny if no sequence has this length
+		 */
+		std::vector<int> PositionMasks(int length) const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that returns the class of a character, pi::CharNone for anything but A-Z and 0-9
+	 */
+	int charClass(char letter);
+
+	/**
+	 * \brief Function that returns the grammar of a country, or null if there is none
+	 *
+	 * \note Knows RO (Romania) and DE (Germany)
+	 */
+	const PlateGrammar* findPlateGrammar(const std::string& name);
+
+	/**
+	 * \brief Function that picks the reading of a plate that best fits the grammar
+	 *
+	 * \param[in] positions - candidates for every letter, best first
+	 *
+	 * \param[out] text - for every position, the best candidate of the class required by the best fitting sequence
+	 *
+	 * \param[out] cost - if not null, receives the summed distance of the chosen reading
+	 *
+	 * \note Falls back to the best candidate of every position if no sequence can be filled from the candidates
+	 */
+	std::string decodePlate(const std::vector<std::vector<LetterCandidate>>& positions, const PlateGrammar& grammar, double* cost = nullptr);
+}
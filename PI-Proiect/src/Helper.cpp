@@ -2,6 +2,8 @@
 /*                                           Headers                                              */
 /**************************************************************************************************/
 #include "Helper.hpp"
+#include "PlateSpec.hpp"
+#include "Regions.hpp"
 
 namespace pi {
 
@@ -30,32 +32,122 @@ namespace pi {
 		steps.clear();
 	}
 
-	/**************************************************************************************************/
-	/*                                     Public Functions                                          */
-	/**************************************************************************************************/
+	namespace {
+		/*which pixels of each image are compared, for a given pair of sizes*/
+		struct SamplingMap {
+			std::vector<int> ref_cols, smpl_cols;
+			std::vector<int> ref_rows, smpl_rows;
+		};
 
-	std::unordered_map<char, cv::Rect> loadLetterRectangles(std::string path) {
-		std::ifstream file(path);
+		void buildIndexMap(int ref_length, int smpl_length, std::vector<int>& ref_indices, std::vector<int>& smpl_indices) {
+			// The larger side is walked one pixel at a time and the smaller one in 16.16 fixed point steps,
+			// so both sides sample nearest neighbour pixels in step with each other
+
+			int length = std::max(ref_length, smpl_length);
+
+			int64_t ref_step = ((int64_t)ref_length << 16) / length;
+			int64_t smpl_step = ((int64_t)smpl_length << 16) / length;
+
+			ref_indices.resize(length);
+			smpl_indices.resize(length);
 
-		if (!file.good()) {
-			std::cout << "Failed to open file " << path << std::endl;
-			return std::unordered_map<char, cv::Rect>();
+			for (int i = BASE_VALUE; i < length; i++) {
+				ref_indices[i] = (int)std::min<int64_t>((i * ref_step) >> 16, ref_length - 1);
+				smpl_indices[i] = (int)std::min<int64_t>((i * smpl_step) >> 16, smpl_length - 1);
+			}
 		}
 
-		auto result = std::unordered_map<char, cv::Rect>();
+		const SamplingMap& samplingMap(cv::Size ref_size, cv::Size smpl_size) {
+			// Only a few size pairs show up (glyph size against itself, gradients against gradients),
+			// so a per thread cache avoids both rebuilding the maps and locking
+
+			thread_local std::map<std::tuple<int, int, int, int>, SamplingMap> cache;
 
-		char ch;
-		int x, y, width, height;
+			auto key = std::make_tuple(ref_size.width, ref_size.height, smpl_size.width, smpl_size.height);
+			auto it = cache.find(key);
 
-		try {
-			while (!file.eof()) {
-				file >> ch >> x >> y >> width >> height;
-				result[ch] = cv::Rect(x, y, width, height);
+			if (it != cache.end()) {
+				return it->second;
 			}
+
+			SamplingMap& map = cache[key];
+
+			buildIndexMap(ref_size.width, smpl_size.width, map.ref_cols, map.smpl_cols);
+			buildIndexMap(ref_size.height, smpl_size.height, map.ref_rows, map.smpl_rows);
+
+			return map;
 		}
-		catch (...) {
-			std::cout << "Failed to read file " << path << std::endl;
-			return std::unordered_map<char, cv::Rect>();
+
+		template <typename T>
+		double sampledDistance(const cv::Mat& ref, const cv::Mat& smpl, double bound) {
+			const SamplingMap& map = samplingMap(ref.size(), smpl.size());
+
+			const int* ref_cols = map.ref_cols.data();
+			const int* smpl_cols = map.smpl_cols.data();
+
+			int rows = (int)map.ref_rows.size();
+			int cols = (int)map.ref_cols.size();
+
+			double count = (double)rows * cols;
+			double sum_bound = bound * count;
+			double distance = 0.0;
+
+			for (int y = BASE_VALUE; y < rows; y++) {
+				const T* ref_row = ref.ptr<T>(map.ref_rows[y]);
+				const T* smpl_row = smpl.ptr<T>(map.smpl_rows[y]);
+
+				for (int x = BASE_VALUE; x < cols; x++) {
+					double value = (double)ref_row[ref_cols[x]] - (double)smpl_row[smpl_cols[x]];
+					distance += value * value;
+				}
+
+				// Once the partial sum is over, the average over all samples will be too
+
+				if (distance > sum_bound) {
+					break;
+				}
+			}
+
+			return distance / count;
+		}
+
+		double equalSizeDistance(const cv::Mat& ref, const cv::Mat& smpl, double bound) {
+			double count = (double)ref.rows * ref.cols;
+
+			if (count == 0.0) {
+				return 0.0;
+			}
+
+			// cv::norm is already vectorized for every type, so use it for the SSD
+			// With a bound, go in bands of rows so that the check can stop early
+
+			if (bound == std::numeric_limits<double>::infinity()) {
+				return cv::norm(ref, smpl, cv::NORM_L2SQR) / count;
+			}
+
+			const int band = 8;
+
+			double sum_bound = bound * count;
+			double distance = 0.0;
+
+			for (int y = BASE_VALUE; y < ref.rows && distance <= sum_bound; y += band) {
+				cv::Range rows(y, std::min(y + band, ref.rows));
+				distance += cv::norm(ref.rowRange(rows), smpl.rowRange(rows), cv::NORM_L2SQR);
+			}
+
+			return distance / count;
+		}
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	std::unordered_map<char, cv::Rect> loadLetterRectangles(std::string path) {
+		auto result = std::unordered_map<char, cv::Rect>();
+
+		for (auto& pair : pi::loadLetterRegions(path)) {
+			result[pair.first] = pair.second.rect;
 		}
 
 		return result;
@@ -79,63 +171,20 @@ namespace pi {
 		return perimeter;
 	}
 
-	bool isLikeALicensePlate(const std::vector<cv::Point>& points) {
+	bool isLikeALicensePlate(const std::vector<cv::Point>& points, int* spec_index) {
 		// Rectangle criteria:
 		// - Opposing edges must be almost parallel
 		// - Adjacent edges must be aproximately 90 degrees apart
+		// - Adjacent edges must have the proportions of one of the active plate formats
 
-		if (points.size() != 4)
-		{
-			return false;  // Can't be a rectangle to begin with
-		}
-
-		cv::Point a = points[BASE_VALUE];
-		cv::Point b = points[1];
-		cv::Point c = points[2];
-		cv::Point d = points[3];
-
-		const double thresh = 0.22;
-
-		bool bad_angles =
-			abs(lineCos(a, b, c)) > thresh ||
-			abs(lineCos(b, c, d)) > thresh ||
-			abs(lineCos(c, d, a)) > thresh ||
-			abs(lineCos(d, a, b)) > thresh;
+		int match = pi::matchPlateSpec(points, pi::defaultPlateSpecs().Specs());
 
-		if (bad_angles)
+		if (spec_index != nullptr)
 		{
-			return false;
+			*spec_index = match;
 		}
 
-		// Do one final check that will throw out many crappy candidates
-		// Proportions for a license plate:
-		// Width: 400 units, Height: 90 units
-		// We'll throw out any rectangles that aren't close to a 40/9 ratio
-
-		// We know it's a rectangle, so we just need adjancent edges
-
-		double target_ratio = 40.0 / 9.0;
-
-		double ratio_higher = 0.35;  // Allow up to x% higher (relative) ratio - plate is longer in one direction
-		double ratio_lower = -0.25;  // Allow up to x% lower (relative) ratio - plate is closer to a square
-
-		cv::Point ab = b - a;
-		cv::Point bc = c - b;
-
-		double ab_len = sqrt(ab.ddot(ab));
-		double bc_len = sqrt(bc.ddot(bc));
-
-		double ratio = ab_len / bc_len;
-		double reverse_ratio = bc_len / ab_len;
-
-		double percentage = (ratio - target_ratio) / target_ratio;
-		double reverse_percentage = (reverse_ratio - target_ratio) / target_ratio;
-
-		bool good_ratio =
-			(ratio_higher >= percentage && percentage >= ratio_lower) ||
-			(ratio_higher >= reverse_percentage && reverse_percentage >= ratio_lower);
-
-		return good_ratio;
+		return match >= 0;
 	}
 
 	double getColorMatch(cv::Mat& img, cv::Scalar color) {
@@ -151,12 +200,14 @@ namespace pi {
 
 		int matchingCount = BASE_VALUE;
 		int total = BASE_VALUE;
-		uint8_t* ptr = img.data;
 		for (int j = BASE_VALUE; j < img.rows; j++) {
+			// Go through row pointers, the image can be a view into a bigger one
+			const uint8_t* ptr = img.ptr<uint8_t>(j);
+
 			for (int i = BASE_VALUE; i < img.cols; i++) {
-				int b = ptr[(img.cols * j + i) * img.channels()];
-				int g = ptr[(img.cols * j + i) * img.channels() + 1];
-				int r = ptr[(img.cols * j + i) * img.channels() + 2];
+				int b = ptr[i * 3];
+				int g = ptr[i * 3 + 1];
+				int r = ptr[i * 3 + 2];
 
 				int luminosity = (b + g + r) / 3;
 
@@ -246,130 +297,230 @@ namespace pi {
 		}
 	}
 
-	void simplifyContours(std::vector<std::vector<cv::Point>>& target, bool doLength)
+	void simplifyContour(std::vector<cv::Point>& contour, bool doLength)
 	{
+		// Every pass only looks at the contour itself, so running all passes on one contour
+		// before moving to the next gives the same result as the old pass-major loop
+
 		int passes = 16;
 		double cos_thresh_base = 0.98;
 		double relax_per_pass = 0.2 / passes;
 
 		for (int pass = 0; pass < passes; pass++)
 		{
-			for (int cindex = 0; cindex < target.size(); cindex++)
-			{
-				std::vector<cv::Point>& contour = target[cindex];
-
-				// Step 1: Collapse small edges into a point
+			// Step 1: Collapse small edges into a point
 
-				if (doLength)
+			if (doLength)
+			{
+				for (uint64_t point = 0; point < contour.size() && contour.size() > 2; point++)
 				{
-					for (uint64_t point = 0; point < contour.size() && contour.size() > 2; point++)
-					{
-						uint64_t index_a = point;
-						uint64_t index_b = (point + 1) % contour.size();
+					uint64_t index_a = point;
+					uint64_t index_b = (point + 1) % contour.size();
 
-						cv::Point a = contour[index_a];
-						cv::Point b = contour[index_b];
-						cv::Point ab = b - a;
+					cv::Point a = contour[index_a];
+					cv::Point b = contour[index_b];
+					cv::Point ab = b - a;
 
-						cv::Point ab_mid = a + (b - a) / 2;
-						double ab_len2 = ab.ddot(ab);
+					cv::Point ab_mid = a + (b - a) / 2;
+					double ab_len2 = ab.ddot(ab);
 
-						double len2_thresh = pow(5.0, 2.0);
+					double len2_thresh = pow(5.0, 2.0);
 
-						if (ab_len2 <= len2_thresh)
-						{
-							contour[index_b] = ab_mid;
-							contour.erase(contour.begin() + index_a);
-							continue;
-						}
+					if (ab_len2 <= len2_thresh)
+					{
+						contour[index_b] = ab_mid;
+						contour.erase(contour.begin() + index_a);
+						continue;
 					}
 				}
+			}
+
+			if (contour.size() <= 2)
+			{
+				continue;
+			}
+
+			// Step 2: Collapse multiple edges that are relatively aligned into one
+
+			for (uint64_t pindex = 0; pindex < contour.size(); pindex++)
+			{
+				uint64_t index_a = pindex;
+				uint64_t index_b = (pindex + 1) % contour.size();
+				uint64_t index_c = (pindex + 2) % contour.size();
+				uint64_t index_d = (pindex + 3) % contour.size();
+
+
+				cv::Point a = contour[index_a];
+				cv::Point b = contour[index_b];
+				cv::Point c = contour[index_c];
+				cv::Point d = contour[index_d];
 
-				if (contour.size() <= 2)
+				cv::Point ab_mid = a + (b - a) / 2;
+				cv::Point bc_mid = b + (c - b) / 2;
+				cv::Point cd_mid = c + (d - c) / 2;
+
+				double abc_cos = lineCos(a, b, c);
+				double bcd_cos = lineCos(b, c, d);
+
+				double cos_thresh = cos_thresh_base - relax_per_pass * pass;
+
+				// cos >= cos_thresh (approaching 1) means we have an (almost) straight line (180 degrees)
+				// Therefore, we can erase the mid point outright
+
+				if (abs(abc_cos) >= cos_thresh)
 				{
+					contour.erase(contour.begin() + index_b);
+					pindex -= 1;
 					continue;
 				}
 
-				// Step 2: Collapse multiple edges that are relatively aligned into one
-
-				for (uint64_t pindex = 0; pindex < contour.size(); pindex++)
+				if (abs(bcd_cos) >= cos_thresh)
 				{
-					uint64_t index_a = pindex;
-					uint64_t index_b = (pindex + 1) % contour.size();
-					uint64_t index_c = (pindex + 2) % contour.size();
-					uint64_t index_d = (pindex + 3) % contour.size();
+					contour.erase(contour.begin() + index_c);
+					pindex -= 1;
+					continue;
+				}
 
+				// Let's try using all four points
+				// Conditions are the same, except the cos threshold is lowered
+				// We'll replace segment b-c with its midpoint if both angles are closer to 180 degrees
 
-					cv::Point a = contour[index_a];
-					cv::Point b = contour[index_b];
-					cv::Point c = contour[index_c];
-					cv::Point d = contour[index_d];
+				cos_thresh *= 0.9;
 
-					cv::Point ab_mid = a + (b - a) / 2;
-					cv::Point bc_mid = b + (c - b) / 2;
-					cv::Point cd_mid = c + (d - c) / 2;
+				if (abs(bcd_cos) >= cos_thresh && abs(abc_cos) >= cos_thresh)
+				{
+					contour[index_c] = bc_mid;
+					contour.erase(contour.begin() + index_b);
+					pindex -= 1;
+					continue;
+				}
 
-					double abc_cos = lineCos(a, b, c);
-					double bcd_cos = lineCos(b, c, d);
+				// One final attempt: simplify segment b-c is it's much smaller than the neighboring segments
 
-					double cos_thresh = cos_thresh_base - relax_per_pass * pass;
+				if (doLength)
+				{
+					cv::Point ab = b - a;
+					cv::Point bc = c - b;
+					cv::Point cd = d - c;
 
-					// cos >= cos_thresh (approaching 1) means we have an (almost) straight line (180 degrees)
-					// Therefore, we can erase the mid point outright
+					double ab_len = sqrt(ab.ddot(ab));
+					double bc_len = sqrt(bc.ddot(bc));
+					double cd_len = sqrt(cd.ddot(cd));
 
-					if (abs(abc_cos) >= cos_thresh)
+					double ratio_thresh = 7.0;
+
+					if (ab_len / bc_len >= ratio_thresh && cd_len / bc_len >= ratio_thresh)
 					{
+						contour[index_c] = bc_mid;
 						contour.erase(contour.begin() + index_b);
 						pindex -= 1;
 						continue;
 					}
+				}
+			}
+		}
+	}
 
-					if (abs(bcd_cos) >= cos_thresh)
-					{
-						contour.erase(contour.begin() + index_c);
-						pindex -= 1;
-						continue;
-					}
+	void simplifyContours(std::vector<std::vector<cv::Point>>& target, bool doLength)
+	{
+		for (auto& contour : target)
+		{
+			simplifyContour(contour, doLength);
+		}
+	}
 
-					// Let's try using all four points
-					// Conditions are the same, except the cos threshold is lowered
-					// We'll replace segment b-c with its midpoint if both angles are closer to 180 degrees
+	std::vector<cv::Range> splitByContourLength(const std::vector<std::vector<cv::Point>>& target, int chunks)
+	{
+		std::vector<cv::Range> ranges;
 
-					cos_thresh *= 0.9;
+		if (target.empty() || chunks <= 0)
+		{
+			return ranges;
+		}
 
-					if (abs(bcd_cos) >= cos_thresh && abs(abc_cos) >= cos_thresh)
-					{
-						contour[index_c] = bc_mid;
-						contour.erase(contour.begin() + index_b);
-						pindex -= 1;
-						continue;
-					}
+		uint64_t total = BASE_VALUE;
 
-					// One final attempt: simplify segment b-c is it's much smaller than the neighboring segments
+		for (auto& contour : target)
+		{
+			total += contour.size() + 1;
+		}
 
-					if (doLength)
-					{
-						cv::Point ab = b - a;
-						cv::Point bc = c - b;
-						cv::Point cd = d - c;
+		// A contour longer than the target weight ends up alone in its chunk,
+		// so the short ones around it can still be spread over the other threads
 
-						double ab_len = sqrt(ab.ddot(ab));
-						double bc_len = sqrt(bc.ddot(bc));
-						double cd_len = sqrt(cd.ddot(cd));
+		uint64_t target_weight = std::max<uint64_t>(total / chunks, 1);
+		uint64_t weight = BASE_VALUE;
+		int start = BASE_VALUE;
 
-						double ratio_thresh = 7.0;
+		for (int cindex = BASE_VALUE; cindex < (int)target.size(); cindex++)
+		{
+			uint64_t current = target[cindex].size() + 1;
 
-						if (ab_len / bc_len >= ratio_thresh && cd_len / bc_len >= ratio_thresh)
-						{
-							contour[index_c] = bc_mid;
-							contour.erase(contour.begin() + index_b);
-							pindex -= 1;
-							continue;
-						}
-					}
-				}
+			if (weight > 0 && weight + current > target_weight)
+			{
+				ranges.push_back(cv::Range(start, cindex));
+				start = cindex;
+				weight = BASE_VALUE;
 			}
+
+			weight += current;
+		}
+
+		ranges.push_back(cv::Range(start, (int)target.size()));
+
+		return ranges;
+	}
+
+	void simplifyContoursParallel(std::vector<std::vector<cv::Point>>& target, bool doLength)
+	{
+		// Not worth waking up the thread pool for a handful of points
+
+		const uint64_t min_points = 2048;
+
+		uint64_t total = BASE_VALUE;
+
+		for (auto& contour : target)
+		{
+			total += contour.size();
+		}
+
+		int threads = cv::getNumThreads();
+
+		if (threads <= 1 || target.size() < 2 || total < min_points)
+		{
+			simplifyContours(target, doLength);
+			return;
 		}
+
+		// Make more chunks than threads so that the pool can balance out the uneven ones
+
+		std::vector<cv::Range> chunks = splitByContourLength(target, threads * 4);
+
+		cv::parallel_for_(cv::Range(BASE_VALUE, (int)chunks.size()), [&](const cv::Range& range)
+		{
+			for (int chunk = range.start; chunk < range.end; chunk++)
+			{
+				for (int cindex = chunks[chunk].start; cindex < chunks[chunk].end; cindex++)
+				{
+					simplifyContour(target[cindex], doLength);
+				}
+			}
+		}, (double)chunks.size());
+	}
+
+	std::vector<int> classifyLicensePlates(const std::vector<std::vector<cv::Point>>& target)
+	{
+		std::vector<int> result(target.size(), -1);
+
+		cv::parallel_for_(cv::Range(BASE_VALUE, (int)target.size()), [&](const cv::Range& range)
+		{
+			for (int cindex = range.start; cindex < range.end; cindex++)
+			{
+				isLikeALicensePlate(target[cindex], &result[cindex]);
+			}
+		});
+
+		return result;
 	}
 
 	void applyContrast(cv::Mat& input, cv::Mat& output, float a, float b, float sa, float sb) {
@@ -571,87 +722,26 @@ namespace pi {
 		return regions;
 	}
 
-	double getImageDistance(const cv::Mat& ref, const cv::Mat& smpl)
+	double getImageDistance(const cv::Mat& ref, const cv::Mat& smpl, double bound)
 	{
 		if (ref.type() != smpl.type())
 		{
 			throw new std::exception("Matrices must have the same type.");
 		}
 
-		int type_used = ref.type();
+		// The pixel type is resolved once here instead of for every sampled pixel
 
-		switch (type_used)
+		switch (ref.type())
 		{
 			case CV_8UC1:
+				return ref.size() == smpl.size() ? equalSizeDistance(ref, smpl, bound) : sampledDistance<uint8_t>(ref, smpl, bound);
+			case CV_32F:
+				return ref.size() == smpl.size() ? equalSizeDistance(ref, smpl, bound) : sampledDistance<float>(ref, smpl, bound);
 			case CV_64F:
-				break;
+				return ref.size() == smpl.size() ? equalSizeDistance(ref, smpl, bound) : sampledDistance<double>(ref, smpl, bound);
 			default:
-				throw new std::exception("Matrices must either be CV_8UC1 or CV_64F");
+				throw new std::exception("Matrices must either be CV_8UC1, CV_32F or CV_64F");
 		}
-
-		double distance = 0.0;
-
-		double ref_x = 0.0, ref_y = 0.0, smpl_x = 0.0, smpl_y = 0.0;
-
-		double ref_advance_x, ref_advance_y, smpl_advance_x, smpl_advance_y;
-
-		double ref_width = ref.size().width, ref_height = ref.size().height;
-		double smpl_width = smpl.size().width, smpl_height = smpl.size().height;
-
-		if (ref_width > smpl_width) {
-			ref_advance_x = 1.0f;
-			smpl_advance_x = smpl_width / ref_width;
-		}
-		else {
-			ref_advance_x = ref_width / smpl_width;
-			smpl_advance_x = 1.0f;
-		}
-
-		if (ref_height > smpl_height) {
-			ref_advance_y = 1.0f;
-			smpl_advance_y = smpl_height / ref_height;
-		}
-		else {
-			ref_advance_y = ref_height / smpl_height;
-			smpl_advance_y = 1.0f;
-		}
-
-		int count = BASE_VALUE;
-
-		while (ref_y < ref_height && smpl_y < smpl_height) {
-			double a, b;
-
-			switch (type_used)
-			{
-				case CV_8UC1:
-					a = ref.at<uint8_t>((int)ref_y, (int)ref_x);
-					b = smpl.at<uint8_t>((int)smpl_y, (int)smpl_x);
-					break;
-				case CV_64F:
-					a = ref.at<double>((int)ref_y, (int)ref_x);
-					b = smpl.at<double>((int)smpl_y, (int)smpl_x);
-					break;
-			}
-
-			double value = abs(a - b);
-			distance += value * value;
-			count++;
-
-			ref_x += ref_advance_x;
-			smpl_x += smpl_advance_x;
-
-			if (ref_x >= ref_width || smpl_x >= smpl_width) {
-				ref_x = 0.0;
-				smpl_x = 0.0;
-
-				ref_y += ref_advance_y;
-				smpl_y += smpl_advance_y;
-			}
-		}
-
-		distance /= count;
-
-		return distance;
 	}
 
 	double getLetterDistance_Old(cv::Mat& ref, cv::Mat& smpl) {
@@ -42,6 +42,8 @@ namespace pi {
 	 * \param[out] result - an unordered map in which char is the letter from the image and Rect is the rectangular region bountig the char
 	 *
 	 * \note The letter's regions are used for the letters segmentation
+	 *
+	 * \note Metrics from the extended format are dropped, pi::loadLetterRegions() keeps them
 	 */
 	std::unordered_map<char, cv::Rect> loadLetterRectangles(std::string path);
 
@@ -54,11 +56,13 @@ namespace pi {
 	 *
 	 * \param[in] points - vector containing the four points of a rectangle
 	 *
+	 * \param[out] spec_index - if not null, receives the index of the matched plate format in pi::defaultPlateSpecs(), or -1
+	 *
 	 * \param[out] returns true if the contour fulfills the conditions
 	 *
-	 * \note
+	 * \note The conditions come from the active formats of pi::defaultPlateSpecs()
 	 */
-	bool isLikeALicensePlate(const std::vector<cv::Point>& points);
+	bool isLikeALicensePlate(const std::vector<cv::Point>& points, int* spec_index = nullptr);
 
 	double getColorMatch(cv::Mat& img, cv::Scalar color);
 
@@ -77,6 +81,40 @@ namespace pi {
 	 */
 	void simplifyContours(std::vector<std::vector<cv::Point>>& target, bool doLength = true);
 
+	/**
+	 * \brief Function that simplifies a single contour, as done by pi::simplifyContours()
+	 *
+	 * \param[in] contour - the contour to simplify in place
+	 */
+	void simplifyContour(std::vector<cv::Point>& contour, bool doLength = true);
+
+	/**
+	 * \brief Function that splits a list of contours into consecutive ranges of similar total length
+	 *
+	 * \param[in] target - the contours to split
+	 *
+	 * \param[in] chunks - the number of ranges wanted
+	 *
+	 * \param[out] ranges - index ranges into target, a contour longer than the average chunk gets its own range
+	 */
+	std::vector<cv::Range> splitByContourLength(const std::vector<std::vector<cv::Point>>& target, int chunks);
+
+	/**
+	 * \brief Parallel version of pi::simplifyContours(), the result is identical to the serial one
+	 *
+	 * \param[in] target - the contours to simplify
+	 *
+	 * \note Contours are handed out to cv::parallel_for_ in chunks weighted by their length
+	 */
+	void simplifyContoursParallel(std::vector<std::vector<cv::Point>>& target, bool doLength = true);
+
+	/**
+	 * \brief Function that runs pi::isLikeALicensePlate() on every contour in parallel
+	 *
+	 * \param[out] result - the index of the matched plate format for every contour, -1 if it doesn't look like a license plate
+	 */
+	std::vector<int> classifyLicensePlates(const std::vector<std::vector<cv::Point>>& target);
+
 	void applyContrast(cv::Mat& img, cv::Mat& output, float a, float b, float sa, float sb);
 
 	cv::Rect getBoundingBox(std::vector<cv::Point>& points);
@@ -92,9 +130,11 @@ namespace pi {
 	 * 
 	 * \param[in] smpl - matrice of the second image
 	 *
+	 * \param[in] bound - if the distance is going to be over this value, stop early and return something above it
+	 *
 	 * \param[out] distance - the distance between the two images
 	 */
-	double getImageDistance(const cv::Mat& ref, const cv::Mat& smpl);
+	double getImageDistance(const cv::Mat& ref, const cv::Mat& smpl, double bound = std::numeric_limits<double>::infinity());
 
 	/**
 	 * \brief Function that calculates the distances between two images in the [0.0 ; 1.0] interval
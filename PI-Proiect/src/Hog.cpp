@@ -0,0 +1,126 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Hog.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace pi {
+
+	namespace {
+		// Same clipping as in the original HOG, keeps a few strong edges from drowning the rest
+		const double hog_clip = 0.2;
+
+		// After clipping and normalizing again no component goes much over 0.25, scale that to the byte range
+		const double hog_quant_scale = 1020.0;
+
+		// Range of the angles given by pi::contour_gradient()
+		const double hog_orientation_range = 90.0;
+	}
+
+	cv::Mat computeOrientationHistograms(const pi::gradient& grad) {
+		std::vector<double> histograms(hog_length, 0.0);
+
+		int rows = grad.magnit.rows;
+		int cols = grad.magnit.cols;
+
+		const double bin_width = hog_orientation_range / hog_bins;
+
+		for (int y = 0; y < rows; y++) {
+			const double* magnitude = grad.magnit.ptr<double>(y);
+			const double* orientation = grad.orient.ptr<double>(y);
+
+			int cell_y = y * hog_cells_y / rows;
+
+			for (int x = 0; x < cols; x++) {
+				if (magnitude[x] <= 0.0) {
+					continue;
+				}
+
+				int cell_x = x * hog_cells_x / cols;
+				double* cell = &histograms[(cell_y * hog_cells_x + cell_x) * hog_bins];
+
+				// Bin centers sit at (i + 0.5) * bin_width, split the vote between the two closest ones
+				// Angles past the first or last center go whole to that bin
+
+				double position = std::min(std::max(orientation[x] / bin_width - 0.5, 0.0), hog_bins - 1.0);
+				double lower = std::floor(position);
+				double fraction = position - lower;
+
+				int bin_low = (int)lower;
+				int bin_high = std::min(bin_low + 1, hog_bins - 1);
+
+				cell[bin_low] += magnitude[x] * (1.0 - fraction);
+				cell[bin_high] += magnitude[x] * fraction;
+			}
+		}
+
+		cv::Mat descriptor = cv::Mat::zeros(1, hog_stride, CV_8U);
+
+		double norm = 0.0;
+
+		for (double value : histograms) {
+			norm += value * value;
+		}
+
+		if (norm <= 0.0) {
+			return descriptor;
+		}
+
+		norm = std::sqrt(norm);
+
+		double clipped_norm = 0.0;
+
+		for (double& value : histograms) {
+			value = std::min(value / norm, hog_clip);
+			clipped_norm += value * value;
+		}
+
+		clipped_norm = std::sqrt(clipped_norm);
+
+		uint8_t* data = descriptor.ptr<uint8_t>();
+
+		for (int i = 0; i < hog_length; i++) {
+			data[i] = cv::saturate_cast<uint8_t>(histograms[i] / clipped_norm * hog_quant_scale);
+		}
+
+		return descriptor;
+	}
+
+	uint32_t histogramDistance(const uint8_t* left, const uint8_t* right, int count) {
+		int i = 0;
+		uint32_t sum = 0;
+
+#if CV_SIMD
+		// |a - b| fits in a byte, the squares are summed four at a time into 32 bit lanes
+
+		cv::v_uint32 acc = cv::vx_setzero_u32();
+
+		const int lanes = cv::v_uint8::nlanes;
+
+		for (; i <= count - lanes; i += lanes) {
+			cv::v_uint8 diff = cv::v_absdiff(cv::vx_load(left + i), cv::vx_load(right + i));
+			acc = cv::v_dotprod_expand_fast(diff, diff, acc);
+		}
+
+		sum = cv::v_reduce_sum(acc);
+
+		cv::vx_cleanup();
+#endif
+
+		for (; i < count; i++) {
+			int diff = (int)left[i] - right[i];
+			sum += diff * diff;
+		}
+
+		return sum;
+	}
+
+	double normalizedHistogramDistance(const uint8_t* left, const uint8_t* right) {
+		// Two unit vectors with no negative components are at most sqrt(2) apart
+
+		const double max_distance = 2.0 * hog_quant_scale * hog_quant_scale;
+
+		return std::min(histogramDistance(left, right, hog_stride) / max_distance, 1.0);
+	}
+}
@@ -0,0 +1,54 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Constants.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Global variables                                        */
+	/*************************************************************************************************/
+
+	/*cell grid and number of orientation bins of the histogram descriptor*/
+	const int hog_cells_x = 4;
+	const int hog_cells_y = 5;
+	const int hog_bins = 6;
+
+	/*number of bytes used by the histograms, and the same padded to a whole number of SIMD registers*/
+	const int hog_length = hog_cells_x * hog_cells_y * hog_bins;
+	const int hog_stride = (hog_length + 63) / 64 * 64;
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that builds magnitude weighted orientation histograms over a grid of cells
+	 *
+	 * \param[in] grad - gradient returned by pi::contour_gradient()
+	 *
+	 * \param[out] descriptor - 1 x pi::hog_stride CV_8U, L2 normalized and quantized, padding is zero
+	 *
+	 * \note pi::contour_gradient() works on absolute derivatives, so orientations are in [0 ; 90] degrees,
+	 *       each pixel votes with its magnitude into the two closest bins
+	 */
+	cv::Mat computeOrientationHistograms(const pi::gradient& grad);
+
+	/**
+	 * \brief Function that calculates the squared L2 distance of two quantized descriptors
+	 *
+	 * \param[in] count - number of bytes, pi::hog_stride for full descriptors
+	 *
+	 * \note Uses the OpenCV universal intrinsics when available
+	 */
+	uint32_t histogramDistance(const uint8_t* left, const uint8_t* right, int count);
+
+	/**
+	 * \brief Function that calculates the distance of two descriptors in the [0.0 ; 1.0] interval
+	 */
+	double normalizedHistogramDistance(const uint8_t* left, const uint8_t* right);
+}
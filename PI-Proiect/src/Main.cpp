@@ -1,366 +1,237 @@
 /**************************************************************************************************/
 /*                                           Headers                                              */
 /**************************************************************************************************/
-#include "Helper.hpp"
-#include "Constants.hpp"
-#include "Gradient.hpp"
+#include "Pipeline.hpp"
+#include "Batch.hpp"
+#include "Video.hpp"
+#include "Daemon.hpp"
+#include "SharedFrames.hpp"
 
 /*************************************************************************************************/
 /*                                       Defines & types                                         */
 /*************************************************************************************************/
 #define BASE_VALUE 0
-const int dimension = 7;
-
-void debug_image(const cv::Mat& image, const std::string& note)
-{
-	static int debug_var = BASE_VALUE;
-	cv::imshow("Debug: " + std::to_string(debug_var++) + " | " + note, image);
-}
-
-void apply_grayscale(cv::Mat& input, cv::Mat& output)
-{
-	cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
-}
-
-void apply_threshold(cv::Mat& input, cv::Mat& output)
-{
-	cv::threshold(input, output, 128, 255, cv::THRESH_OTSU);
-}
-
-void apply_filter(cv::Mat& input, cv::Mat& output)
-{
-	cv::filter2D(input, output, -1, pi::gauss3x3);
-}
-
-void apply_equalize(cv::Mat& input, cv::Mat& output)
-{
-	cv::equalizeHist(input, output);
-}
-
-void apply_canny(cv::Mat& input, cv::Mat& output)
-{
-	cv::Canny(input, output, 100, 210, 3);
-}
-
-void apply_contrast(cv::Mat& input, cv::Mat& output)
-{
-	pi::applyContrast(input, output, 50, 150, 20, 150);
-}
-
-struct FontData
-{
-	cv::Mat sample;
-
-	std::unordered_map<char, cv::Mat> letters;
-	std::unordered_map<char, pi::gradient> letter_gradients;
-};
-
-struct PlateData
-{
-	std::vector<cv::Mat> segmented_plates;
-	cv::Mat plate_drawing;
-};
-
-struct LetterInfo
-{
-	cv::Mat unknown_letter;
-
-	char letter = '?';
-	double distance = 2500;
-
-	char value_letter = '?';
-	double value_distance = 2500;
-
-	char mag_letter = '?';
-	double mag_distance = 2500;
 
-	char angle_letter = '?';
-	double angle_distance = 2500;
-};
-
-struct PlateTextData
-{
-	std::vector<std::vector<LetterInfo>> plate_letters;
-};
-
-FontData initialize_font()
-{
-	FontData fontData;
+int main(int argc, char** argv) {
+	cv::CommandLineParser parser(argc, argv,
+		"{@fileinput || input image}"
+		"{plates | EU | comma separated plate formats to look for (EU, US, MOTO)}"
+		"{top-k | 4 | maximum number of plates read per image, 0 for no limit}"
+		"{nms-iou | 0.3 | overlap above which two plate candidates are considered the same plate}"
+		"{shortlist | 8 | glyphs kept by the zoning prefilter for full matching, 0 to compare against all}"
+		"{candidates | 3 | readings kept for every letter}"
+		"{grammar | | plate layout used to constrain the reading (RO, DE), empty for none}"
+		"{reread-below | 0.5 | plates read with a lower confidence are read again against every glyph}"
+		"{mode | contours | plate detection mode: contours or edges (sliding windows over vertical edge density)}"
+		"{classifier | | weights file written by --train, letters are classified with it instead of template matching}"
+		"{train | | train a classifier on distorted font glyphs, write its weights to this file and exit}"
+		"{augment | 40 | distorted copies of every glyph made for training}"
+		"{batch | false | read the letters of all plates together, compared against every glyph}"
+		"{font-pack | | font pack written by --compile-font, mapped instead of decoding the font at startup}"
+		"{compile-font | | compile the font with all of its features into a pack at this path and exit}"
+		"{generate-font-header | | write the compiled font as a C++ header (EmbeddedFont.hpp) for PI_EMBEDDED_FONT builds and exit}"
+		"{fonts | | font list with the fonts of every plate format or country, see pi::FontRegistry::Load()}"
+		"{headless | | directory of images or text file with one image path per line, read without any window}"
+		"{threads | 0 | worker threads of the headless and daemon modes, 0 for one per hardware thread}"
+		"{output | | JSONL file written by the headless modes, empty for the standard output}"
+		"{video | | video file, stream URL or camera index read frame by frame, without any window}"
+		"{stride | 1 | only every stride-th video frame is processed}"
+		"{realtime | true | drop video frames when processing falls behind their timestamps}"
+		"{daemon | | serve readings on this Unix domain socket until interrupted, see Daemon.hpp for the protocol}"
+		"{shared-frames | | POSIX shared memory object holding a ring of BGR frames, see SharedFrames.hpp for its layout}"
+		"{skip-stale | true | only read the newest shared frame when several are waiting}"
+		"{motion | false | skip video frames where nothing moved and only search the changed parts of the others}"
+		"{track | false | follow video plates across frames, reading each one again only when it changes or is uncertain}");
+
+	if (parser.has("generate-font-header"))
+	{
+		FontData fontData = initialize_font();
 
-	fontData.sample = cv::imread("Resources\\Mittelschrift_sample.png", cv::IMREAD_GRAYSCALE);
+		if (!pi::writeFontHeader(parser.get<cv::String>("generate-font-header"), fontData.bank, fontData.metrics))
+		{
+			std::cerr << "Failed to write " << parser.get<cv::String>("generate-font-header") << std::endl;
+			return 1;
+		}
 
-	for (auto& pair : pi::loadLetterRectangles("Resources\\Mittelschrift_regions.txt"))
-	{
-		fontData.letters[pair.first] = cv::Mat(fontData.sample, pair.second);
+		return 0;
 	}
 
-	for (auto& pair : fontData.letters)
+	if (parser.has("compile-font"))
 	{
-		fontData.letter_gradients[pair.first] = pi::contour_gradient(pair.second);
-	}
-
-	return fontData;
-}
-
-PlateData detect_plate(const FontData& fontData, const cv::Mat& sample)
-{
-	PlateData plateData;
-
-	cv::Mat result;
-	pi::OperationList process;
-
-	process.AddStep(apply_grayscale);
-	process.AddStep(apply_filter);
-	process.AddStep(apply_equalize);
-	process.AddStep(apply_canny);
-
-	process.Run(sample, result);
-
-	//debug_image(result, "Plate");
-	//apply_canny(result, result);
-
-	// Find contours using OpenCV
-
-	std::vector<std::vector<cv::Point>> contours;
-	std::vector<cv::Vec4i> hierarchy;
-	cv::findContours(result, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-	// Simplify contours - multiple straight (or almost straight) lines become a single line
-	// Prune contours that are way too small
+		FontData fontData = initialize_font();
 
-	pi::simplifyContours(contours);
-	pi::pruneShort(contours, 60);
-
-	// Draw resulting rectangles - these show the zones that can contain potential car plates
+		if (!pi::writeFontPack(parser.get<cv::String>("compile-font"), fontData.glyphs, fontData.bank, fontData.metrics))
+		{
+			std::cerr << "Failed to write " << parser.get<cv::String>("compile-font") << std::endl;
+			return 1;
+		}
 
-	cv::Mat drawing = sample.clone();
-	cv::RNG rng(12345);
+		return 0;
+	}
 
-	for (size_t i = BASE_VALUE; i < contours.size(); i++)
+	if (parser.has("train"))
 	{
-		cv::Scalar color = cv::Scalar(BASE_VALUE, 255, BASE_VALUE);
-
-		if (!pi::isLikeALicensePlate(contours[i]))
-		{
-			//color = cv::Scalar(0, 0, 255);
-			continue;  // Do not show close candidates
-		}
+		pi::AugmentSettings augment;
+		augment.copies = parser.get<int>("augment");
 
-		cv::drawContours(drawing, contours, (int)i, color, 2, cv::LINE_8, cv::noArray(), 0);
+		FontData fontData = initialize_font();
 
-		uint64_t size = contours[i].size();
-		for (int pindex = 0; pindex < size; pindex++)
+		if (!train_classifier(fontData, parser.get<cv::String>("train"), augment, pi::TrainSettings()))
 		{
-			cv::drawMarker(drawing, contours[i][pindex], cv::Scalar::all(255.0 * pindex / size), 2, 5, 1, 1);
+			std::cerr << "Failed to write " << parser.get<cv::String>("train") << std::endl;
+			return 1;
 		}
-	}
 
-	// Show results
+		return 0;
+	}
 
-	plateData.plate_drawing = drawing;
+	pi::defaultPlateSpecs().ActivateOnly(parser.get<cv::String>("plates"));
 
-	// Cut the license plate out
+	DetectionSettings detectionSettings;
+	detectionSettings.candidates.top_k = parser.get<int>("top-k");
+	detectionSettings.candidates.iou_thresh = parser.get<double>("nms-iou");
 
-	for (int i = BASE_VALUE; i < contours.size(); i++)
+	if (parser.get<cv::String>("mode") == "edges")
 	{
-		if (pi::isLikeALicensePlate(contours[i]))
-		{
-			auto rect = pi::getBoundingBox(contours[i]);
-
-			cv::Mat plate = cv::Mat(sample, cv::Range(rect.y, rect.height + rect.y), cv::Range(rect.x, rect.width + rect.x));
-			
-			plateData.segmented_plates.push_back(plate);
-		}
+		detectionSettings.mode = DetectionMode::EdgeWindows;
 	}
 
-	return plateData;
-}
+	ReadSettings readSettings;
+	readSettings.shortlist = parser.get<int>("shortlist");
+	readSettings.candidates = parser.get<int>("candidates");
+	readSettings.reread_below = parser.get<double>("reread-below");
+	readSettings.batch = parser.get<bool>("batch");
 
-LetterInfo read_letter(const FontData& fontData, const cv::Mat& letter)
-{
-	LetterInfo letterInfo;
-	letterInfo.unknown_letter = letter;
+	std::string grammar = parser.get<cv::String>("grammar");
 
-	for (auto& pair : fontData.letters)
+	if (!grammar.empty() && (readSettings.grammar = pi::findPlateGrammar(grammar)) == nullptr)
 	{
-		auto temp = cv::Mat(letter);
-		auto grad_info = pi::contour_gradient(temp);
-
-		double value_distance = powf(1.0f / 255.0f, 2.0f) * pi::getImageDistance(pair.second, letter);
-
-		double mag_distance = powf(1.0f / 255.0f, 2.0f) * pi::getImageDistance(fontData.letter_gradients.at(pair.first).magnit, grad_info.magnit);
-		double angle_distance = powf(1.0f / 360.0f, 2.0f) * pi::getImageDistance(fontData.letter_gradients.at(pair.first).orient, grad_info.orient);
+		std::cerr << "Unknown plate grammar " << grammar << std::endl;
+	}
 
-		double finalDistance = value_distance * 0.6 + mag_distance * 0.25 + angle_distance * 0.5;
+	pi::FontRegistry fonts;
 
-		if (value_distance < letterInfo.value_distance)
-		{
-			letterInfo.value_distance = value_distance;
-			letterInfo.value_letter = pair.first;
-		}
+	if (parser.has("fonts"))
+	{
+		fonts.Load(parser.get<cv::String>("fonts"));
+		readSettings.fonts = &fonts;
+	}
 
-		if (mag_distance < letterInfo.mag_distance)
-		{
-			letterInfo.mag_distance = mag_distance;
-			letterInfo.mag_letter = pair.first;
-		}
+	pi::LetterClassifier classifier;
 
-		if (angle_distance < letterInfo.angle_distance)
+	if (parser.has("classifier"))
+	{
+		if (classifier.Load(parser.get<cv::String>("classifier")))
 		{
-			letterInfo.angle_distance = angle_distance;
-			letterInfo.angle_letter = pair.first;
+			readSettings.classifier = &classifier;
+			readSettings.confidence = pi::classifierConfidence();
 		}
-
-		if (finalDistance < letterInfo.distance)
+		else
 		{
-			letterInfo.distance = finalDistance;
-			letterInfo.letter = pair.first;
+			std::cerr << "Failed to load classifier " << parser.get<cv::String>("classifier") << ", matching templates" << std::endl;
 		}
 	}
 
-	return letterInfo;
-}
-
-PlateTextData detect_and_read_text(const FontData& fontData, const PlateData& plateData)
-{
-	PlateTextData plateTextData;
-
-	std::vector<std::vector<cv::Point>> contours;
-	std::vector<cv::Vec4i> hierarchy;
+	FontData fontData;
 
-	pi::OperationList wordProcess;
+#ifdef PI_EMBEDDED_FONT
+	bool font_loaded = !parser.has("font-pack") && load_embedded_font(fontData);
+#else
+	bool font_loaded = false;
+#endif
 
-	wordProcess.AddStep(apply_grayscale);
-	wordProcess.AddStep(apply_threshold);
-	wordProcess.AddStep(apply_canny);
+	// With a font registry the default font goes through it too, so it's decoded once and shared with the mapped fonts
+	// A pack or the embedded font cost next to nothing to load, those are kept as the default instead
 
-	for (auto& plate : plateData.segmented_plates)
+	if (!font_loaded && readSettings.fonts != nullptr && !parser.has("font-pack"))
 	{
-		plateTextData.plate_letters.push_back(std::vector<LetterInfo>());
-		auto& letterList = *plateTextData.plate_letters.rbegin();
-
-		cv::Mat result;
-		wordProcess.Run(plate, result);
-
-		cv::findContours(result, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-		cv::Mat drawing = plate.clone();
-		cv::RNG rng(12345);
-
-		for (size_t i = BASE_VALUE; i < contours.size(); i++)
+		if (!fonts.Mapped(pi::default_font_key))
 		{
-			cv::Scalar color = cv::Scalar(BASE_VALUE, 255, BASE_VALUE);
-
-			cv::drawContours(drawing, contours, (int)i, color, 2, cv::LINE_8, cv::noArray(), BASE_VALUE);
+			if (!fonts.Has("Mittelschrift"))
+			{
+				fonts.Add({ "Mittelschrift", "Resources\\Mittelschrift_sample.png", "Resources\\Mittelschrift_regions.txt", "" });
+			}
 
+			fonts.Map(pi::default_font_key, "Mittelschrift");
 		}
 
-		debug_image(drawing, "Plate crap");
-
-		// Simplify contours - multiple straight (or almost straight) lines become a single line
-
-		pi::simplifyContours(contours, false); // - Can't do due to sensitive algorithm!
-		pi::pruneShort(contours, 15);
+		// Resolved now, a default that can't be loaded would otherwise leave every plate without templates
 
-		// Calculate median height and width
-		// The range of heights for letters is small
-		// However, letters can have varying widths
-
-		std::vector<cv::Rect> bboxes;
-
-		for (auto& contour : contours)
+		if (fonts.Fonts(pi::default_font_key).empty())
 		{
-			auto bbox = pi::getBoundingBox(contour);
-
-			bboxes.push_back(bbox);
+			std::cerr << "Failed to load the default font of the registry, decoding the font" << std::endl;
 		}
-
-		std::vector<cv::Rect> bbox_wsort = bboxes;
-		std::vector<cv::Rect> bbox_hsort = bboxes;
-
-		auto width_less = [](cv::Rect& left, cv::Rect& right) { return left.width < right.width; };
-		auto height_less = [](cv::Rect& left, cv::Rect& right) { return left.height < right.height; };
-
-		std::sort(bbox_hsort.begin(), bbox_hsort.end(), height_less);
-		std::sort(bbox_wsort.begin(), bbox_wsort.end(), width_less);
-
-		int median_index = bbox_hsort.size() / 2;
-		double median_height = bbox_hsort[median_index].height;
-		double median_width = bbox_wsort[median_index].width;
-
-		// std::cout << "Median Width: " << median_width << " | Median Height: " << median_height << std::endl;
-
-		if (bbox_wsort.size() >= 3)
+		else
 		{
-			// Use the average of the median and the left / right value
-
-			median_width = (bbox_wsort[median_index - 1LL].width + median_width + bbox_wsort[median_index + 1LL].width) / 3.0;
-			median_height = (bbox_hsort[median_index - 1LL].height + median_height + bbox_hsort[median_index + 1LL].height) / 3.0;
+			font_loaded = true;
 		}
+	}
 
-		// TODO: Sort letters based on X / Y components
-
-		double width_threshold = 0.75;
-		double height_threshold = 0.1;
+	if (!font_loaded && (!parser.has("font-pack") || !pi::openFontPack(parser.get<cv::String>("font-pack"), fontData)))
+	{
+		if (parser.has("font-pack"))
+		{
+			std::cerr << "Failed to load font pack " << parser.get<cv::String>("font-pack") << ", decoding the font" << std::endl;
+		}
 
-		// The height for a font varies by a low amount
-		// Meanwhile the width can vary by a high amount
-		// Therefore, drop all contours that vary:
-		// * by >10% for height, or
-		// * by >75% for width
-		// Those are unlikely to be letters
+		fontData = initialize_font();
+	}
 
-		// Remove letters based on criteria above
+	// Headless batch, the font is shared by every worker and nothing is shown
 
-		for (int i = BASE_VALUE; i < bboxes.size(); i++)
-		{
-			auto bbox = bboxes[i];
+	if (parser.has("headless"))
+	{
+		set_debug_windows(false);
 
-			double width_variance = abs(bbox.width - median_width) / median_width;
-			double height_variance = abs(bbox.height - median_height) / median_height;
+		BatchSettings batchSettings;
+		batchSettings.threads = parser.get<int>("threads");
+		batchSettings.output = parser.get<cv::String>("output");
 
-			bool not_a_letter =
-				width_variance >= width_threshold ||
-				height_variance > height_threshold;
+		std::vector<std::string> files = list_batch_inputs(parser.get<cv::String>("headless"));
 
-			if (not_a_letter)
-			{
-				bboxes.erase(bboxes.begin() + i);
-				i--;
-			}
-		}
+		return run_batch(fontData, files, detectionSettings, readSettings, batchSettings) == BASE_VALUE ? 0 : 1;
+	}
 
-		// Sort letters so that they appear in word order
+	// Daemon, the font and the scratch state of every worker stay loaded between requests
 
-		auto letter_less = [](cv::Rect& left, cv::Rect& right) 
-		{ 
-			return left.x < right.x || left.x <= right.x && left.y < right.y;
-		};
+	if (parser.has("daemon"))
+	{
+		set_debug_windows(false);
 
-		std::sort(bboxes.begin(), bboxes.end(), letter_less);
+		DaemonSettings daemonSettings;
+		daemonSettings.threads = parser.get<int>("threads");
 
-		// Prepare results
+		return run_daemon(fontData, parser.get<cv::String>("daemon"), detectionSettings, readSettings, daemonSettings) ? 0 : 1;
+	}
 
-		for (int i = BASE_VALUE; i < bboxes.size(); i++)
-		{
-			auto bbox = bboxes[i];
+	// Shared memory, frames are read in place from the ring of a capture process
 
-			cv::Mat unknown_letter = cv::Mat(plate, bbox);
-			cv::cvtColor(unknown_letter, unknown_letter, cv::COLOR_BGR2GRAY);
+	if (parser.has("shared-frames"))
+	{
+		set_debug_windows(false);
 
-			LetterInfo letterInfo = read_letter(fontData, unknown_letter);
+		SharedFrameSettings sharedSettings;
+		sharedSettings.skip_stale = parser.get<bool>("skip-stale");
+		sharedSettings.output = parser.get<cv::String>("output");
 
-			letterList.push_back(letterInfo);
-		}
+		return run_shared_frames(fontData, parser.get<cv::String>("shared-frames"), detectionSettings, readSettings, sharedSettings) ? 0 : 1;
 	}
 
-	return plateTextData;
-}
+	// Video, frames are processed as they come with their timestamps
 
+	if (parser.has("video"))
+	{
+		set_debug_windows(false);
 
+		VideoSettings videoSettings;
+		videoSettings.stride = parser.get<int>("stride");
+		videoSettings.realtime = parser.get<bool>("realtime");
+		videoSettings.track = parser.get<bool>("track");
+		videoSettings.motion = parser.get<bool>("motion");
+		videoSettings.output = parser.get<cv::String>("output");
 
-int main(int argc, char** argv) {
-	cv::CommandLineParser parser(argc, argv, "{@fileinput || input image}");
+		return run_video(fontData, parser.get<cv::String>("video"), detectionSettings, readSettings, videoSettings) ? 0 : 1;
+	}
 
 	// Read image
 
@@ -387,19 +258,17 @@ int main(int argc, char** argv) {
 		}
 	}
 
-	FontData fontData = initialize_font();
-
 	// Actual processing
 
 	try {
 
 		// Step 1 : detect plate(s)
 
-		PlateData plateData = detect_plate(fontData, sample);
+		PlateData plateData = detect_plate(fontData, sample, detectionSettings);
 
 		// Step 2 : read text from plate(s)
 
-		PlateTextData plateTextData = detect_and_read_text(fontData, plateData);
+		PlateTextData plateTextData = detect_and_read_text(fontData, plateData, readSettings);
 
 		// Step 3 : output info!
 
@@ -414,6 +283,11 @@ int main(int argc, char** argv) {
 		{
 			std::cout << "================== Plate " << i << " ================== " << std::endl << std::endl;
 
+			std::cout << "Format: " << pi::defaultPlateSpecs().Specs()[plateData.plate_specs[i]].name << std::endl;
+			std::cout << "Score: " << plateData.plate_scores[i] << std::endl;
+			std::cout << "Text: " << plateTextData.plate_text[i] << std::endl;
+			std::cout << "Confidence: " << plateTextData.plate_confidence[i] << std::endl << std::endl;
+
 			cv::imshow(std::string("Plate ") + std::to_string(i), plateData.segmented_plates[i]);
 
 			auto& letterList = plateTextData.plate_letters[i];
@@ -424,6 +298,16 @@ int main(int argc, char** argv) {
 
 				std::cout << "====> Character " << j << std::endl;
 
+				std::cout << "Candidates:";
+
+				for (int k = BASE_VALUE; k < letterInfo.candidates.Size(); k++)
+				{
+					std::cout << " " << letterInfo.candidates[k].letter << " (" << letterInfo.candidates[k].score << ")";
+				}
+
+				std::cout << std::endl;
+				std::cout << "Confidence: " << letterInfo.confidence << std::endl;
+
 				std::cout << "Value (best): " << letterInfo.value_letter << " = " << letterInfo.value_distance << std::endl;
 				std::cout << "Magnitude: " << letterInfo.mag_letter << " = " << letterInfo.mag_distance << std::endl;
 				std::cout << "Angle: " << letterInfo.angle_letter << " = " << letterInfo.angle_distance << std::endl;
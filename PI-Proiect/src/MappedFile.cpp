@@ -0,0 +1,135 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pi {
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+
+		HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		file = handle;
+
+		LARGE_INTEGER length;
+
+		if (!GetFileSizeEx(handle, &length) || length.QuadPart == 0) {
+			Close();
+			return false;
+		}
+
+		mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping == nullptr) {
+			Close();
+			return false;
+		}
+
+		data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (data == nullptr) {
+			Close();
+			return false;
+		}
+
+		size = (size_t)length.QuadPart;
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (data != nullptr) {
+			UnmapViewOfFile(data);
+		}
+
+		if (mapping != nullptr) {
+			CloseHandle(mapping);
+		}
+
+		if (file != nullptr) {
+			CloseHandle(file);
+		}
+
+		data = nullptr;
+		size = 0;
+		mapping = nullptr;
+		file = nullptr;
+	}
+
+#else
+
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+
+		descriptor = open(path.c_str(), O_RDONLY);
+
+		if (descriptor < 0) {
+			return false;
+		}
+
+		struct stat status;
+
+		if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+			Close();
+			return false;
+		}
+
+		void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+		if (view == MAP_FAILED) {
+			Close();
+			return false;
+		}
+
+		data = (const uint8_t*)view;
+		size = (size_t)status.st_size;
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (data != nullptr) {
+			munmap((void*)data, size);
+		}
+
+		if (descriptor >= 0) {
+			close(descriptor);
+		}
+
+		data = nullptr;
+		size = 0;
+		descriptor = -1;
+	}
+
+#endif
+
+	const uint8_t* MappedFile::Data() const {
+		return data;
+	}
+
+	size_t MappedFile::Size() const {
+		return size;
+	}
+}
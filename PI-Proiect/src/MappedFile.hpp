@@ -0,0 +1,50 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*a whole file mapped read-only into memory, the pages are shared with every other process mapping it*/
+	class MappedFile {
+	private:
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void* file = nullptr;
+		void* mapping = nullptr;
+#else
+		int descriptor = -1;
+#endif
+
+	public:
+
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile();
+
+		/**
+		 * \brief Function that maps a file, unmapping the previous one
+		 *
+		 * \param[out] returns false if the file couldn't be opened or mapped, empty files can't be mapped either
+		 */
+		bool Open(const std::string& path);
+
+		void Close();
+
+		const uint8_t* Data() const;
+
+		size_t Size() const;
+	};
+}
@@ -0,0 +1,108 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Motion.hpp"
+
+namespace pi {
+
+	namespace {
+		MotionMap wholeFrame(const cv::Mat& frame, const cv::Size& blocks) {
+			MotionMap map;
+			map.blocks = cv::Mat(blocks, CV_8U, cv::Scalar(255));
+			map.regions.push_back(cv::Rect(0, 0, frame.cols, frame.rows));
+			map.changed = 1.0;
+
+			return map;
+		}
+	}
+
+	bool MotionMap::Moving() const {
+		return !regions.empty();
+	}
+
+	MotionDetector::MotionDetector(const MotionSettings& settings) : settings(settings) {}
+
+	MotionMap MotionDetector::Update(const cv::Mat& frame) {
+		int width = std::max(settings.block, std::min(settings.width, frame.cols));
+		int height = std::max(settings.block, (int)std::round((double)frame.rows * width / frame.cols));
+
+		// Downscale first, the color conversion and everything after only touch the small image
+
+		cv::Mat small;
+		cv::resize(frame, small, cv::Size(width, height), 0.0, 0.0, cv::INTER_AREA);
+
+		if (small.channels() == 3) {
+			cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+		}
+
+		cv::GaussianBlur(small, small, cv::Size(3, 3), 0.0);
+
+		cv::Size blocks((width + settings.block - 1) / settings.block, (height + settings.block - 1) / settings.block);
+
+		if (background.size() != small.size()) {
+			small.convertTo(background, CV_32F);
+			return wholeFrame(frame, blocks);
+		}
+
+		cv::Mat reference;
+		background.convertTo(reference, CV_8U);
+
+		cv::Mat changed;
+		cv::absdiff(small, reference, changed);
+		cv::threshold(changed, changed, settings.diff_thresh, 255, cv::THRESH_BINARY);
+
+		cv::accumulateWeighted(small, background, settings.learning_rate);
+
+		// Ratio of changed pixels of every block, partial blocks on the border count as whole ones
+
+		cv::Mat padded;
+		cv::copyMakeBorder(changed, padded, 0, blocks.height * settings.block - height, 0, blocks.width * settings.block - width,
+			cv::BORDER_CONSTANT, cv::Scalar(0));
+
+		cv::Mat fraction;
+		cv::resize(padded, fraction, blocks, 0.0, 0.0, cv::INTER_AREA);
+
+		MotionMap map;
+		cv::threshold(fraction, map.blocks, settings.block_fraction * 255.0, 255, cv::THRESH_BINARY);
+
+		map.changed = (double)cv::countNonZero(map.blocks) / blocks.area();
+
+		if (map.changed == 0.0) {
+			return map;
+		}
+
+		if (map.changed > settings.full_frame_fraction) {
+			return wholeFrame(frame, blocks);
+		}
+
+		// Neighbouring changed blocks are searched together, each group as one region
+
+		cv::Mat grown;
+		cv::dilate(map.blocks, grown, cv::Mat(), cv::Point(-1, -1), settings.margin);
+
+		cv::Mat labels, stats, centroids;
+		int count = cv::connectedComponentsWithStats(grown, labels, stats, centroids, 8, CV_32S);
+
+		double scale_x = (double)frame.cols / width * settings.block;
+		double scale_y = (double)frame.rows / height * settings.block;
+
+		cv::Rect bounds(0, 0, frame.cols, frame.rows);
+
+		for (int label = 1; label < count; label++) {
+			int x = stats.at<int>(label, cv::CC_STAT_LEFT);
+			int y = stats.at<int>(label, cv::CC_STAT_TOP);
+			int w = stats.at<int>(label, cv::CC_STAT_WIDTH);
+			int h = stats.at<int>(label, cv::CC_STAT_HEIGHT);
+
+			cv::Rect region(cvFloor(x * scale_x), cvFloor(y * scale_y), cvCeil(w * scale_x), cvCeil(h * scale_y));
+
+			map.regions.push_back(region & bounds);
+		}
+
+		return map;
+	}
+
+	void MotionDetector::Reset() {
+		background.release();
+	}
+}
@@ -0,0 +1,73 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*parameters of the frame differencing in front of the plate detection*/
+	struct MotionSettings {
+		// Width the frames are compared at, the height keeps the aspect ratio
+		int width = 160;
+
+		// Side of the blocks of the change map, in downscaled pixels
+		int block = 8;
+
+		// Gray level difference from the background above which a pixel has changed
+		int diff_thresh = 20;
+
+		// Ratio of changed pixels above which a whole block has changed
+		double block_fraction = 0.1;
+
+		// Weight of every new frame in the running average background
+		double learning_rate = 0.05;
+
+		// Blocks added around every changed area, so plates just entering it aren't cut
+		int margin = 1;
+
+		// Ratio of changed blocks above which the whole frame is searched, as after a change of lighting
+		double full_frame_fraction = 0.5;
+	};
+
+	/*what changed in a frame, the regions are in frame coordinates*/
+	struct MotionMap {
+		cv::Mat blocks;                  // CV_8U, non zero for the changed blocks
+		std::vector<cv::Rect> regions;   // Bounding rectangles of groups of changed blocks, with the margin
+		double changed = 0.0;            // Ratio of changed blocks
+
+		bool Moving() const;
+	};
+
+	/*background model kept at a low resolution, cheap enough to run on every frame*/
+	class MotionDetector {
+	private:
+
+		MotionSettings settings;
+
+		cv::Mat background;  // CV_32F running average of the downscaled grayscale frames
+
+	public:
+
+		MotionDetector(const MotionSettings& settings = MotionSettings());
+
+		/**
+		 * \brief Function that compares a frame with the background and then updates the background with it
+		 *
+		 * \param[in] frame - BGR or grayscale frame
+		 *
+		 * \param[out] returns the changed blocks and the regions worth searching for plates
+		 *
+		 * \note The first frame, or the first one after a change of size, is reported as changed everywhere
+		 */
+		MotionMap Update(const cv::Mat& frame);
+
+		void Reset();
+	};
+}
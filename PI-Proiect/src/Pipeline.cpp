@@ -0,0 +1,1068 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Pipeline.hpp"
+
+#include <numeric>
+
+#ifdef PI_EMBEDDED_FONT
+#include "EmbeddedFont.hpp"
+#endif
+
+static bool debug_windows = true;
+
+void set_debug_windows(bool enabled)
+{
+	debug_windows = enabled;
+}
+
+void debug_image(const cv::Mat& image, const std::string& note)
+{
+	if (!debug_windows)
+	{
+		return;  // Headless runs have no display, and workers mustn't share the counter
+	}
+
+	static int debug_var = BASE_VALUE;
+	cv::imshow("Debug: " + std::to_string(debug_var++) + " | " + note, image);
+}
+
+void apply_grayscale(cv::Mat& input, cv::Mat& output)
+{
+	cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
+}
+
+void apply_threshold(cv::Mat& input, cv::Mat& output)
+{
+	cv::threshold(input, output, 128, 255, cv::THRESH_OTSU);
+}
+
+void apply_filter(cv::Mat& input, cv::Mat& output)
+{
+	cv::filter2D(input, output, -1, pi::gauss3x3);
+}
+
+void apply_equalize(cv::Mat& input, cv::Mat& output)
+{
+	cv::equalizeHist(input, output);
+}
+
+void apply_canny(cv::Mat& input, cv::Mat& output)
+{
+	cv::Canny(input, output, 100, 210, 3);
+}
+
+void apply_contrast(cv::Mat& input, cv::Mat& output)
+{
+	pi::applyContrast(input, output, 50, 150, 20, 150);
+}
+
+FontData initialize_font()
+{
+	FontData fontData;
+	fontData.name = "Mittelschrift";
+
+	if (!pi::decodeFont("Resources\\Mittelschrift_sample.png", "Resources\\Mittelschrift_regions.txt", fontData))
+	{
+		std::cerr << "Failed to load the Mittelschrift font from Resources" << std::endl;
+	}
+
+	return fontData;
+}
+
+#ifdef PI_EMBEDDED_FONT
+
+static_assert(pi::embedded_font::version == pi::font_pack_version, "EmbeddedFont.hpp is out of date, generate it again");
+static_assert(pi::embedded_font::hog_stride == pi::hog_stride, "EmbeddedFont.hpp is out of date, generate it again");
+
+bool load_embedded_font(FontData& fontData)
+{
+	// The arrays live in the executable, the bank only points at them
+
+	namespace font = pi::embedded_font;
+
+	fontData = FontData();
+	fontData.metrics.min_width = font::min_width;
+	fontData.metrics.max_width = font::max_width;
+	fontData.metrics.advance = font::advance;
+
+	return fontData.bank.Wrap(
+		std::vector<char>(font::labels, font::labels + font::glyph_count),
+		std::vector<double>(font::aspects, font::aspects + font::glyph_count),
+		font::stride, font::zoning_stride, font::data, font::zoning, font::hog);
+}
+
+#endif
+
+bool train_classifier(const FontData& fontData, const std::string& path, const pi::AugmentSettings& augment, const pi::TrainSettings& train)
+{
+	std::vector<std::vector<float>> samples;
+	std::vector<char> labels;
+
+	cv::RNG rng(train.seed);
+
+	for (auto& pair : fontData.regions)
+	{
+		cv::Mat glyph = cv::Mat(fontData.sample, pair.second.rect);
+
+		for (int copy = BASE_VALUE; copy <= augment.copies; copy++)
+		{
+			// The first copy is the glyph as it is in the font
+
+			cv::Mat distorted = copy == BASE_VALUE ? glyph : pi::augmentGlyph(glyph, rng, augment);
+
+			samples.push_back(pi::glyphFeatures(pi::describeGlyph(distorted)));
+			labels.push_back(pair.first);
+		}
+	}
+
+	pi::LetterClassifier classifier;
+	classifier.Train(samples, labels, train);
+
+	// Accuracy on the training samples, only a sanity check
+
+	int correct = BASE_VALUE;
+
+	for (int i = BASE_VALUE; i < samples.size(); i++)
+	{
+		pi::LetterCandidates candidates;
+		candidates.Reset(1);
+		classifier.Classify(samples[i], pi::CharAny, candidates);
+
+		correct += candidates[0].letter == labels[i];
+	}
+
+	std::cout << "Trained on " << samples.size() << " samples of " << classifier.Size() << " glyphs, "
+		<< "training accuracy " << (double)correct / std::max<size_t>(samples.size(), 1) << std::endl;
+
+	return classifier.Save(path);
+}
+
+std::vector<pi::PlateCandidate> find_contour_candidates(const cv::Mat& sample, const cv::Mat& edges)
+{
+	// Find contours using OpenCV
+
+	std::vector<std::vector<cv::Point>> contours;
+	std::vector<cv::Vec4i> hierarchy;
+	cv::findContours(edges, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+	// Simplify contours - multiple straight (or almost straight) lines become a single line
+	// Prune contours that are way too small
+
+	pi::simplifyContoursParallel(contours);
+	pi::pruneShort(contours, 60);
+
+	std::vector<int> plate_specs = pi::classifyLicensePlates(contours);
+
+	std::vector<pi::PlateCandidate> candidates;
+
+	for (size_t i = BASE_VALUE; i < contours.size(); i++)
+	{
+		if (plate_specs[i] < 0)
+		{
+			continue;
+		}
+
+		pi::PlateCandidate candidate;
+		candidate.contour = contours[i];
+		candidate.box = pi::getBoundingBox(contours[i]) & cv::Rect(0, 0, sample.cols, sample.rows);
+		candidate.spec_index = plate_specs[i];
+
+		if (candidate.box.area() == 0)
+		{
+			continue;
+		}
+
+		candidates.push_back(std::move(candidate));
+	}
+
+	return candidates;
+}
+
+PlateData detect_plate_regions(const FontData& fontData, const cv::Mat& sample, const DetectionSettings& settings)
+{
+	PlateData found;
+
+	for (auto& region : settings.regions)
+	{
+		cv::Rect bounded = region & cv::Rect(BASE_VALUE, BASE_VALUE, sample.cols, sample.rows);
+
+		if (bounded.empty())
+		{
+			continue;
+		}
+
+		DetectionSettings region_settings = settings;
+		region_settings.regions.clear();
+		region_settings.draw = false;
+
+		// Window heights are fractions of the searched image, keep them relative to the whole one
+
+		for (double& scale : region_settings.proposals.scales)
+		{
+			scale *= (double)sample.rows / bounded.height;
+		}
+
+		PlateData plateData = detect_plate(fontData, sample(bounded), region_settings);
+
+		for (int i = BASE_VALUE; i < plateData.segmented_plates.size(); i++)
+		{
+			for (auto& corner : plateData.plate_corners[i])
+			{
+				corner += bounded.tl();
+			}
+
+			found.segmented_plates.push_back(plateData.segmented_plates[i]);
+			found.plate_specs.push_back(plateData.plate_specs[i]);
+			found.plate_scores.push_back(plateData.plate_scores[i]);
+			found.plate_boxes.push_back(plateData.plate_boxes[i] + bounded.tl());
+			found.plate_corners.push_back(plateData.plate_corners[i]);
+		}
+	}
+
+	// Regions can overlap, the same plate found twice is kept once and the limit applies to all of them together
+
+	std::vector<int> order(found.segmented_plates.size());
+	std::iota(order.begin(), order.end(), BASE_VALUE);
+	std::stable_sort(order.begin(), order.end(), [&](int left, int right) { return found.plate_scores[left] > found.plate_scores[right]; });
+
+	PlateData plateData;
+
+	for (int i : order)
+	{
+		if (settings.candidates.top_k > BASE_VALUE && plateData.segmented_plates.size() >= settings.candidates.top_k)
+		{
+			break;
+		}
+
+		bool duplicate = std::any_of(plateData.plate_boxes.begin(), plateData.plate_boxes.end(), [&](const cv::Rect& kept) {
+			return pi::intersectionOverUnion(kept, found.plate_boxes[i]) > settings.candidates.iou_thresh;
+		});
+
+		if (duplicate)
+		{
+			continue;
+		}
+
+		plateData.segmented_plates.push_back(found.segmented_plates[i]);
+		plateData.plate_specs.push_back(found.plate_specs[i]);
+		plateData.plate_scores.push_back(found.plate_scores[i]);
+		plateData.plate_boxes.push_back(found.plate_boxes[i]);
+		plateData.plate_corners.push_back(found.plate_corners[i]);
+	}
+
+	if (settings.draw)
+	{
+		plateData.plate_drawing = sample.clone();
+
+		for (auto& region : settings.regions)
+		{
+			cv::rectangle(plateData.plate_drawing, region, cv::Scalar(255, BASE_VALUE, BASE_VALUE), 1);
+		}
+
+		for (auto& corners : plateData.plate_corners)
+		{
+			cv::polylines(plateData.plate_drawing, corners, true, cv::Scalar(BASE_VALUE, 255, BASE_VALUE), 2, cv::LINE_8);
+		}
+	}
+
+	return plateData;
+}
+
+PlateData detect_plate(const FontData& fontData, const cv::Mat& sample, const DetectionSettings& settings)
+{
+	// Only the given regions are searched, each one as an image of its own
+
+	if (!settings.regions.empty())
+	{
+		return detect_plate_regions(fontData, sample, settings);
+	}
+
+	PlateData plateData;
+
+	cv::Mat gray;
+	pi::OperationList process;
+
+	process.AddStep(apply_grayscale);
+	process.AddStep(apply_filter);
+	process.AddStep(apply_equalize);
+
+	process.Run(sample, gray);
+
+	cv::Mat result;
+	apply_canny(gray, result);
+
+	//debug_image(result, "Plate");
+
+	// Both modes give 4-point candidates with their plate format, contours are checked with pi::isLikeALicensePlate()
+	// Edge windows are sized for their format and skip contour extraction and simplification altogether
+
+	std::vector<pi::PlateCandidate> candidates;
+
+	switch (settings.mode)
+	{
+		case DetectionMode::EdgeWindows:
+			candidates = pi::proposeEdgeWindows(gray, settings.proposals);
+			break;
+		case DetectionMode::Contours:
+		default:
+			candidates = find_contour_candidates(sample, result);
+			break;
+	}
+
+	// Score the rectangles that look like plates
+	// Nested or overlapping candidates around the same plate are reduced to the best one
+
+	for (auto& candidate : candidates)
+	{
+		pi::scorePlateCandidate(candidate, sample, result, settings.candidates);
+	}
+
+	candidates = pi::suppressNonMaximum(std::move(candidates), settings.candidates);
+
+	// Draw resulting rectangles - these show the zones that can contain potential car plates
+
+	cv::Mat drawing;
+
+	if (settings.draw)
+	{
+		drawing = sample.clone();
+
+		for (auto& candidate : candidates)
+		{
+			cv::Scalar color = cv::Scalar(BASE_VALUE, 255, BASE_VALUE);
+
+			cv::polylines(drawing, candidate.contour, true, color, 2, cv::LINE_8);
+
+			uint64_t size = candidate.contour.size();
+			for (int pindex = 0; pindex < size; pindex++)
+			{
+				cv::drawMarker(drawing, candidate.contour[pindex], cv::Scalar::all(255.0 * pindex / size), 2, 5, 1, 1);
+			}
+		}
+	}
+
+	// Show results
+
+	plateData.plate_drawing = drawing;
+
+	// Cut the license plate out
+
+	for (auto& candidate : candidates)
+	{
+		// Warp the plate into the canonical size of its format
+		// This drops the background around tilted plates and gives the letters a known height
+
+		CV_Assert(candidate.spec_index >= BASE_VALUE && candidate.spec_index < (int)pi::defaultPlateSpecs().Specs().size());
+
+		const pi::PlateSpec& spec = pi::defaultPlateSpecs().Specs()[candidate.spec_index];
+
+		pi::WarpCache* cache = settings.warp_cache != nullptr ? settings.warp_cache : &pi::defaultWarpCache();
+
+		cv::Mat plate = pi::rectifyPlate(sample, candidate.contour, spec.canonical_size, cache);
+
+		plateData.segmented_plates.push_back(plate);
+		plateData.plate_specs.push_back(candidate.spec_index);
+		plateData.plate_scores.push_back(candidate.score);
+		plateData.plate_boxes.push_back(candidate.box);
+		plateData.plate_corners.push_back(candidate.contour);
+	}
+
+	return plateData;
+}
+
+void add_glyph_reading(LetterInfo& letterInfo, char character, const pi::GlyphDistance& glyphDistance)
+{
+	double value_distance = glyphDistance.value;
+	double mag_distance = glyphDistance.magnitude;
+	double angle_distance = glyphDistance.angle;
+	double finalDistance = glyphDistance.total;
+
+	if (value_distance < letterInfo.value_distance)
+	{
+		letterInfo.value_distance = value_distance;
+		letterInfo.value_letter = character;
+	}
+
+	if (mag_distance < letterInfo.mag_distance)
+	{
+		letterInfo.mag_distance = mag_distance;
+		letterInfo.mag_letter = character;
+	}
+
+	if (angle_distance < letterInfo.angle_distance)
+	{
+		letterInfo.angle_distance = angle_distance;
+		letterInfo.angle_letter = character;
+	}
+
+	if (finalDistance < letterInfo.distance)
+	{
+		letterInfo.distance = finalDistance;
+		letterInfo.letter = character;
+	}
+
+	letterInfo.candidates.Insert(character, finalDistance);
+}
+
+std::vector<const FontData*> plate_fonts(const FontData& fontData, const ReadSettings& settings, int spec_index)
+{
+	// The country picks the fonts if it has any mapped, then the plate format, then the default fonts of the registry
+	// The font given here is only read when the registry has nothing for the plate
+
+	if (settings.fonts != nullptr)
+	{
+		std::vector<const FontData*> fonts;
+
+		if (settings.grammar != nullptr)
+		{
+			fonts = settings.fonts->Fonts(settings.grammar->Name());
+		}
+
+		if (fonts.empty() && spec_index >= BASE_VALUE)
+		{
+			fonts = settings.fonts->Fonts(pi::defaultPlateSpecs().Specs()[spec_index].name);
+		}
+
+		if (fonts.empty())
+		{
+			fonts = settings.fonts->Fonts(pi::default_font_key);
+		}
+
+		if (!fonts.empty())
+		{
+			return fonts;
+		}
+	}
+
+	return { &fontData };
+}
+
+LetterInfo read_letter(const std::vector<const FontData*>& fonts, const cv::Mat& letter, const ReadSettings& settings, int class_mask)
+{
+	LetterInfo letterInfo;
+	letterInfo.unknown_letter = letter;
+
+	// Features of the unknown letter are extracted once, then compared against the bank
+	// Stage one keeps the glyphs with the closest zoning features, stage two compares only those
+	// Likely glyphs go first, so the best distance so far quickly cuts the other comparisons short
+
+	pi::GlyphDescriptor unknown = pi::describeGlyph(letter);
+
+	letterInfo.candidates.Reset(settings.candidates);
+
+	if (settings.classifier != nullptr)
+	{
+		// One int8 dot product per class instead of the template comparisons
+
+		settings.classifier->Classify(pi::glyphFeatures(unknown), class_mask, letterInfo.candidates);
+
+		if (!letterInfo.candidates.Empty())
+		{
+			letterInfo.letter = letterInfo.candidates[0].letter;
+			letterInfo.distance = letterInfo.candidates[0].distance;
+		}
+
+		letterInfo.confidence = pi::calibrateCandidates(letterInfo.candidates, settings.confidence);
+
+		return letterInfo;
+	}
+
+	// Every font of the plate adds its readings to the same candidates, the bound carries over between them
+
+	for (const FontData* font : fonts)
+	{
+		const pi::TemplateBank& bank = font->bank;
+
+		pi::NormalizedGlyph normalized = bank.Normalize(unknown);
+
+		std::vector<int> order = settings.shortlist > 0 ?
+			bank.Shortlist(unknown, settings.shortlist, class_mask) :
+			bank.VisitOrder(unknown.aspect, class_mask);
+
+		for (int index : order)
+		{
+			pi::GlyphDistance glyphDistance;
+
+			// Anything worse than the last of the kept candidates is of no use
+
+			if (!bank.Distance(normalized, index, letterInfo.candidates.Bound(), glyphDistance))
+			{
+				continue;  // Can't make it into the candidates anymore
+			}
+
+			add_glyph_reading(letterInfo, bank.Label(index), glyphDistance);
+		}
+	}
+
+	letterInfo.confidence = pi::calibrateCandidates(letterInfo.candidates, settings.confidence);
+
+	return letterInfo;
+}
+
+std::vector<int> letter_class_masks(const ReadSettings& settings, int count)
+{
+	// Positions the grammar pins to digits or letters are only matched against that subset
+
+	return settings.grammar != nullptr ?
+		settings.grammar->PositionMasks(count) :
+		std::vector<int>(count, pi::CharAny);
+}
+
+cv::Mat cut_letter(const cv::Mat& plate, const cv::Rect& bbox)
+{
+	cv::Mat unknown_letter = cv::Mat(plate, bbox);
+	cv::cvtColor(unknown_letter, unknown_letter, cv::COLOR_BGR2GRAY);
+
+	return unknown_letter;
+}
+
+double decode_plate_letters(std::vector<LetterInfo>& letterList, const ReadSettings& settings, std::string& text)
+{
+	// Pick the reading that fits the plate layout, this sorts out O / 0 and I / 1 mixups
+
+	text.clear();
+
+	if (settings.grammar != nullptr)
+	{
+		std::vector<std::vector<pi::LetterCandidate>> positions;
+
+		for (auto& letterInfo : letterList)
+		{
+			positions.push_back(letterInfo.candidates.ToVector());
+		}
+
+		text = pi::decodePlate(positions, *settings.grammar);
+
+		for (int i = BASE_VALUE; i < letterList.size(); i++)
+		{
+			LetterInfo& letterInfo = letterList[i];
+
+			letterInfo.letter = text[i];
+
+			// The grammar may have picked a reading other than the best one, take its own confidence
+
+			for (int j = BASE_VALUE; j < letterInfo.candidates.Size(); j++)
+			{
+				if (letterInfo.candidates[j].letter == text[i])
+				{
+					letterInfo.distance = letterInfo.candidates[j].distance;
+					letterInfo.confidence = pi::candidateConfidence(letterInfo.candidates[j], settings.confidence);
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		for (auto& letterInfo : letterList)
+		{
+			text += letterInfo.letter;
+		}
+	}
+
+	std::vector<double> confidences;
+
+	for (auto& letterInfo : letterList)
+	{
+		confidences.push_back(letterInfo.confidence);
+	}
+
+	return pi::plateConfidence(confidences);
+}
+
+double read_plate_letters(const std::vector<const FontData*>& fonts, const cv::Mat& plate, const std::vector<cv::Rect>& bboxes,
+	const ReadSettings& settings, std::vector<LetterInfo>& letterList, std::string& text)
+{
+	std::vector<int> class_masks = letter_class_masks(settings, (int)bboxes.size());
+
+	letterList.clear();
+
+	for (int i = BASE_VALUE; i < bboxes.size(); i++)
+	{
+		LetterInfo letterInfo = read_letter(fonts, cut_letter(plate, bboxes[i]), settings, class_masks[i]);
+
+		letterList.push_back(letterInfo);
+	}
+
+	return decode_plate_letters(letterList, settings, text);
+}
+
+std::vector<LetterInfo> read_letters_batch(const std::vector<cv::Mat>& letters, const std::vector<int>& class_masks,
+	const std::vector<std::vector<const FontData*>>& letter_fonts, const ReadSettings& settings)
+{
+	std::vector<pi::GlyphDescriptor> descriptors;
+
+	for (auto& letter : letters)
+	{
+		descriptors.push_back(pi::describeGlyph(letter));
+	}
+
+	std::vector<LetterInfo> letterInfos(letters.size());
+
+	for (int i = BASE_VALUE; i < letters.size(); i++)
+	{
+		letterInfos[i].unknown_letter = letters[i];
+		letterInfos[i].candidates.Reset(settings.candidates);
+	}
+
+	// Letters are grouped by font, then every group is compared against its whole bank in one blocked pass
+
+	std::map<const FontData*, std::vector<int>> groups;
+
+	for (int i = BASE_VALUE; i < letters.size(); i++)
+	{
+		for (const FontData* font : letter_fonts[i])
+		{
+			groups[font].push_back(i);
+		}
+	}
+
+	for (auto& group : groups)
+	{
+		const pi::TemplateBank& bank = group.first->bank;
+
+		std::vector<pi::NormalizedGlyph> unknowns;
+
+		for (int i : group.second)
+		{
+			unknowns.push_back(bank.Normalize(descriptors[i]));
+		}
+
+		std::vector<pi::GlyphDistance> distances;
+		bank.BatchDistances(unknowns, distances);
+
+		int count = bank.Size();
+
+		for (int row = BASE_VALUE; row < group.second.size(); row++)
+		{
+			int i = group.second[row];
+
+			for (int index = BASE_VALUE; index < count; index++)
+			{
+				if (pi::charClass(bank.Label(index)) & class_masks[i])
+				{
+					add_glyph_reading(letterInfos[i], bank.Label(index), distances[(size_t)row * count + index]);
+				}
+			}
+		}
+	}
+
+	for (auto& letterInfo : letterInfos)
+	{
+		letterInfo.confidence = pi::calibrateCandidates(letterInfo.candidates, settings.confidence);
+	}
+
+	return letterInfos;
+}
+
+std::vector<cv::Rect> segment_letters(const cv::Mat& plate, const pi::FontMetrics& metrics = pi::FontMetrics())
+{
+	std::vector<std::vector<cv::Point>> contours;
+	std::vector<cv::Vec4i> hierarchy;
+
+	pi::OperationList wordProcess;
+
+	wordProcess.AddStep(apply_grayscale);
+	wordProcess.AddStep(apply_threshold);
+	wordProcess.AddStep(apply_canny);
+
+	cv::Mat result;
+	wordProcess.Run(plate, result);
+
+	cv::findContours(result, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+	// The drawing is only worth making when there is a window to show it in
+
+	if (debug_windows)
+	{
+		cv::Mat drawing = plate.clone();
+
+		for (size_t i = BASE_VALUE; i < contours.size(); i++)
+		{
+			cv::Scalar color = cv::Scalar(BASE_VALUE, 255, BASE_VALUE);
+
+			cv::drawContours(drawing, contours, (int)i, color, 2, cv::LINE_8, cv::noArray(), BASE_VALUE);
+		}
+
+		debug_image(drawing, "Plate crap");
+	}
+
+	// Simplify contours - multiple straight (or almost straight) lines become a single line
+
+	pi::simplifyContours(contours, false); // - Can't do due to sensitive algorithm!
+	pi::pruneShort(contours, 15);
+
+	// Calculate median height and width
+	// The range of heights for letters is small
+	// However, letters can have varying widths
+
+	std::vector<cv::Rect> bboxes;
+
+	for (auto& contour : contours)
+	{
+		auto bbox = pi::getBoundingBox(contour);
+
+		bboxes.push_back(bbox);
+	}
+
+	if (bboxes.empty())
+	{
+		return bboxes;  // Nothing that could be a letter, no median to take
+	}
+
+	std::vector<cv::Rect> bbox_wsort = bboxes;
+	std::vector<cv::Rect> bbox_hsort = bboxes;
+
+	auto width_less = [](cv::Rect& left, cv::Rect& right) { return left.width < right.width; };
+	auto height_less = [](cv::Rect& left, cv::Rect& right) { return left.height < right.height; };
+
+	std::sort(bbox_hsort.begin(), bbox_hsort.end(), height_less);
+	std::sort(bbox_wsort.begin(), bbox_wsort.end(), width_less);
+
+	int median_index = bbox_hsort.size() / 2;
+	double median_height = bbox_hsort[median_index].height;
+	double median_width = bbox_wsort[median_index].width;
+
+	// std::cout << "Median Width: " << median_width << " | Median Height: " << median_height << std::endl;
+
+	if (bbox_wsort.size() >= 3)
+	{
+		// Use the average of the median and the left / right value
+
+		median_width = (bbox_wsort[median_index - 1LL].width + median_width + bbox_wsort[median_index + 1LL].width) / 3.0;
+		median_height = (bbox_hsort[median_index - 1LL].height + median_height + bbox_hsort[median_index + 1LL].height) / 3.0;
+	}
+
+	// TODO: Sort letters based on X / Y components
+
+	double width_threshold = 0.75;
+	double height_threshold = 0.1;
+
+	double min_width = median_width * (1.0 - width_threshold);
+	double max_width = median_width * (1.0 + width_threshold);
+
+	// The height for a font varies by a low amount
+	// Meanwhile the width can vary by a high amount
+	// Therefore, drop all contours that vary:
+	// * by >10% for height, or
+	// * by >75% for width
+	// Those are unlikely to be letters
+
+	// The proportions of the font, when its regions file has them, replace the guess from the median width
+
+	if (metrics.Valid())
+	{
+		double metrics_tolerance = 0.25;
+
+		min_width = metrics.min_width * median_height * (1.0 - metrics_tolerance);
+		max_width = metrics.max_width * median_height * (1.0 + metrics_tolerance);
+
+		// Letters touching each other come out as one wide box, cut it at the font's advance
+
+		double advance = metrics.advance * median_height;
+
+		for (int i = BASE_VALUE; i < bboxes.size(); i++)
+		{
+			cv::Rect bbox = bboxes[i];
+
+			int parts = (int)std::round(bbox.width / advance);
+
+			if (bbox.width <= max_width || parts < 2 || abs(bbox.height - median_height) / median_height > height_threshold)
+			{
+				continue;
+			}
+
+			bboxes.erase(bboxes.begin() + i);
+
+			for (int part = BASE_VALUE; part < parts; part++)
+			{
+				int left = bbox.x + bbox.width * part / parts;
+				int right = bbox.x + bbox.width * (part + 1) / parts;
+
+				bboxes.insert(bboxes.begin() + i + part, cv::Rect(left, bbox.y, right - left, bbox.height));
+			}
+
+			i += parts - 1;
+		}
+	}
+
+	// Remove letters based on criteria above
+
+	for (int i = BASE_VALUE; i < bboxes.size(); i++)
+	{
+		auto bbox = bboxes[i];
+
+		double height_variance = abs(bbox.height - median_height) / median_height;
+
+		bool not_a_letter =
+			bbox.width <= min_width || bbox.width >= max_width ||
+			height_variance > height_threshold;
+
+		if (not_a_letter)
+		{
+			bboxes.erase(bboxes.begin() + i);
+			i--;
+		}
+	}
+
+	// Sort letters so that they appear in word order
+
+	auto letter_less = [](cv::Rect& left, cv::Rect& right) 
+	{ 
+		return left.x < right.x || left.x <= right.x && left.y < right.y;
+	};
+
+	std::sort(bboxes.begin(), bboxes.end(), letter_less);
+
+	return bboxes;
+}
+
+std::vector<PlateTextData> detect_and_read_text_batch(const FontData& fontData, const std::vector<PlateData>& frames, const ReadSettings& settings)
+{
+	std::vector<PlateTextData> results(frames.size());
+
+	// Segment every plate of every frame first, then read all of their letters together
+
+	std::vector<cv::Mat> letters;
+	std::vector<int> class_masks;
+	std::vector<std::vector<const FontData*>> letter_fonts;
+
+	std::vector<std::vector<std::vector<cv::Rect>>> frame_bboxes(frames.size());
+
+	for (int f = BASE_VALUE; f < frames.size(); f++)
+	{
+		for (int p = BASE_VALUE; p < frames[f].segmented_plates.size(); p++)
+		{
+			const cv::Mat& plate = frames[f].segmented_plates[p];
+
+			std::vector<const FontData*> fonts = plate_fonts(fontData, settings, frames[f].plate_specs[p]);
+			std::vector<cv::Rect> bboxes = segment_letters(plate, fonts.front()->metrics);
+			std::vector<int> masks = letter_class_masks(settings, (int)bboxes.size());
+
+			for (int i = BASE_VALUE; i < bboxes.size(); i++)
+			{
+				letters.push_back(cut_letter(plate, bboxes[i]));
+				class_masks.push_back(masks[i]);
+				letter_fonts.push_back(fonts);
+			}
+
+			frame_bboxes[f].push_back(std::move(bboxes));
+		}
+	}
+
+	std::vector<LetterInfo> letterInfos = read_letters_batch(letters, class_masks, letter_fonts, settings);
+
+	// Hand the letters back to their plates, in the same order they were collected
+
+	size_t next = BASE_VALUE;
+
+	for (int f = BASE_VALUE; f < frames.size(); f++)
+	{
+		PlateTextData& plateTextData = results[f];
+
+		for (auto& bboxes : frame_bboxes[f])
+		{
+			std::vector<LetterInfo> letterList(letterInfos.begin() + next, letterInfos.begin() + next + bboxes.size());
+			next += bboxes.size();
+
+			std::string text;
+			double confidence = decode_plate_letters(letterList, settings, text);
+
+			plateTextData.plate_letters.push_back(std::move(letterList));
+			plateTextData.plate_text.push_back(text);
+			plateTextData.plate_confidence.push_back(confidence);
+		}
+	}
+
+	return results;
+}
+
+double rescore_reading(const std::vector<LetterInfo>& letterList, const std::string& text, const pi::ConfidenceSettings& settings)
+{
+	std::vector<double> confidences;
+
+	for (int i = BASE_VALUE; i < letterList.size() && i < text.size(); i++)
+	{
+		const pi::LetterCandidates& candidates = letterList[i].candidates;
+
+		double confidence = 0.0;
+
+		// A letter outside of the kept candidates is one the templates don't back at all
+
+		for (int j = BASE_VALUE; j < candidates.Size(); j++)
+		{
+			if (candidates[j].letter == text[i])
+			{
+				confidence = pi::candidateConfidence(candidates[j], settings);
+				break;
+			}
+		}
+
+		confidences.push_back(confidence);
+	}
+
+	return pi::plateConfidence(confidences);
+}
+
+PlateTextData detect_and_read_text(const FontData& fontData, const PlateData& plateData, const ReadSettings& settings)
+{
+	// Batches compare every letter against every glyph, there is nothing left to read again
+
+	if (settings.batch && settings.classifier == nullptr)
+	{
+		return detect_and_read_text_batch(fontData, { plateData }, settings)[BASE_VALUE];
+	}
+
+	PlateTextData plateTextData;
+
+	for (int p = BASE_VALUE; p < plateData.segmented_plates.size(); p++)
+	{
+		const cv::Mat& plate = plateData.segmented_plates[p];
+
+		plateTextData.plate_letters.push_back(std::vector<LetterInfo>());
+		auto& letterList = *plateTextData.plate_letters.rbegin();
+
+		// Only the fonts of this plate's country or format are compared, not every glyph known
+		// The first of them gives the proportions the letters are segmented with
+
+		std::vector<const FontData*> fonts = plate_fonts(fontData, settings, plateData.plate_specs[p]);
+
+		std::vector<cv::Rect> bboxes = segment_letters(plate, fonts.front()->metrics);
+
+		// Low confidence plates get a slower pass against every glyph, confident ones are left as they are
+		// Readings of the classifier are checked against the templates the same way
+
+		std::string text;
+		double confidence = read_plate_letters(fonts, plate, bboxes, settings, letterList, text);
+
+		if (confidence < settings.reread_below && (settings.shortlist > 0 || settings.classifier != nullptr))
+		{
+			ReadSettings thorough = settings;
+			thorough.shortlist = 0;  // Same number of candidates, so both confidences come from softmaxes of the same size
+			thorough.classifier = nullptr;
+			thorough.confidence = ReadSettings().confidence;
+
+			std::vector<LetterInfo> reread;
+			std::string reread_text;
+			double reread_confidence = read_plate_letters(fonts, plate, bboxes, thorough, reread, reread_text);
+
+			// The classifier's confidence is on a scale of its own, its reading is scored against the template candidates instead
+
+			double current = settings.classifier != nullptr ? rescore_reading(reread, text, thorough.confidence) : confidence;
+
+			if (reread_confidence > current)
+			{
+				letterList = std::move(reread);
+				text = reread_text;
+				confidence = reread_confidence;
+			}
+		}
+
+		plateTextData.plate_text.push_back(text);
+		plateTextData.plate_confidence.push_back(confidence);
+	}
+
+	return plateTextData;
+}
+
+FrameResult process_frame(const FontData& fontData, const cv::Mat& frame, const DetectionSettings& detection, const ReadSettings& read)
+{
+	FrameResult result;
+
+	auto start = std::chrono::steady_clock::now();
+
+	result.plates = detect_plate(fontData, frame, detection);
+
+	auto detected = std::chrono::steady_clock::now();
+
+	result.text = detect_and_read_text(fontData, result.plates, read);
+
+	auto done = std::chrono::steady_clock::now();
+
+	result.times.detect = std::chrono::duration<double, std::milli>(detected - start).count();
+	result.times.read = std::chrono::duration<double, std::milli>(done - detected).count();
+
+	return result;
+}
+
+std::string json_string(const std::string& text)
+{
+	std::ostringstream out;
+
+	out << '"';
+
+	for (char c : text)
+	{
+		switch (c)
+		{
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20)
+				{
+					out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+				}
+				else
+				{
+					out << c;
+				}
+				break;
+		}
+	}
+
+	out << '"';
+
+	return out.str();
+}
+
+std::string plates_to_json(const FrameResult& result)
+{
+	const PlateData& plateData = result.plates;
+	const PlateTextData& plateTextData = result.text;
+
+	std::ostringstream out;
+
+	out << "[";
+
+	for (int i = BASE_VALUE; i < plateTextData.plate_text.size(); i++)
+	{
+		const cv::Rect& box = plateData.plate_boxes[i];
+
+		out << (i > BASE_VALUE ? "," : "") << "{";
+		out << "\"format\":" << json_string(pi::defaultPlateSpecs().Specs()[plateData.plate_specs[i]].name);
+		out << ",\"box\":[" << box.x << "," << box.y << "," << box.width << "," << box.height << "]";
+
+		out << ",\"corners\":[";
+
+		for (int j = BASE_VALUE; j < plateData.plate_corners[i].size(); j++)
+		{
+			const cv::Point& corner = plateData.plate_corners[i][j];
+			out << (j > BASE_VALUE ? "," : "") << "[" << corner.x << "," << corner.y << "]";
+		}
+
+		out << "]";
+		out << ",\"score\":" << plateData.plate_scores[i];
+		out << ",\"text\":" << json_string(plateTextData.plate_text[i]);
+		out << ",\"confidence\":" << plateTextData.plate_confidence[i];
+
+		out << ",\"letters\":[";
+
+		const std::vector<LetterInfo>& letterList = plateTextData.plate_letters[i];
+
+		for (int j = BASE_VALUE; j < letterList.size(); j++)
+		{
+			out << (j > BASE_VALUE ? "," : "") << "{\"letter\":" << json_string(std::string(1, letterList[j].letter))
+				<< ",\"confidence\":" << letterList[j].confidence << "}";
+		}
+
+		out << "]}";
+	}
+
+	out << "]";
+
+	return out.str();
+}
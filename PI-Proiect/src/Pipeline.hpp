@@ -0,0 +1,201 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Helper.hpp"
+#include "Constants.hpp"
+#include "Gradient.hpp"
+#include "PlateSpec.hpp"
+#include "Candidates.hpp"
+#include "Rectify.hpp"
+#include "Proposals.hpp"
+#include "Glyph.hpp"
+#include "TemplateBank.hpp"
+#include "Grammar.hpp"
+#include "Confidence.hpp"
+#include "Classifier.hpp"
+#include "FontPack.hpp"
+#include "Font.hpp"
+
+/*************************************************************************************************/
+/*                                       Defines & types                                         */
+/*************************************************************************************************/
+
+// The font read when no registry font is mapped to a plate
+using FontData = pi::Font;
+
+enum class DetectionMode
+{
+	Contours,
+	EdgeWindows
+};
+
+struct DetectionSettings
+{
+	DetectionMode mode = DetectionMode::Contours;
+
+	pi::CandidateSettings candidates;
+	pi::ProposalSettings proposals;
+
+	// Warp maps of this caller, null to share pi::defaultWarpCache()
+	pi::WarpCache* warp_cache = nullptr;
+
+	// Draw the plate candidates on a copy of the image, only needed when it is shown
+	bool draw = true;
+
+	// Parts of the image searched for plates, empty for the whole image
+	std::vector<cv::Rect> regions;
+};
+
+struct ReadSettings
+{
+	// Number of glyphs kept by the zoning prefilter for the full comparison, 0 to compare against all of them
+	int shortlist = 8;
+
+	// Number of candidates kept for every letter, used when decoding with the grammar
+	int candidates = 3;
+
+	// Allowed plate layouts, null to read every letter on its own
+	const pi::PlateGrammar* grammar = nullptr;
+
+	pi::ConfidenceSettings confidence;
+
+	// Plates below this confidence are read again against every glyph
+	double reread_below = 0.5;
+
+	// Read the letters of all plates together against the whole bank, see detect_and_read_text_batch()
+	bool batch = false;
+
+	// Trained classifier used instead of template matching, null to match templates
+	const pi::LetterClassifier* classifier = nullptr;
+
+	// Fonts per plate format or country, null to read every plate with the default font
+	const pi::FontRegistry* fonts = nullptr;
+};
+
+struct PlateData
+{
+	std::vector<cv::Mat> segmented_plates;
+	std::vector<int> plate_specs;  // Index of the matched format in pi::defaultPlateSpecs()
+	std::vector<double> plate_scores;
+	std::vector<cv::Rect> plate_boxes;
+	std::vector<std::vector<cv::Point>> plate_corners;
+	cv::Mat plate_drawing;
+};
+
+struct LetterInfo
+{
+	cv::Mat unknown_letter;
+
+	// Infinite distances and '?' mean that no glyph was compared
+
+	char letter = '?';
+	double distance = std::numeric_limits<double>::infinity();
+
+	// Confidence in [0 ; 1] that letter is right, see pi::calibrateCandidates()
+	double confidence = 0.0;
+
+	// Per feature bests, only over the glyphs that weren't cut short by the total distance bound
+
+	char value_letter = '?';
+	double value_distance = std::numeric_limits<double>::infinity();
+
+	char mag_letter = '?';
+	double mag_distance = std::numeric_limits<double>::infinity();
+
+	char angle_letter = '?';
+	double angle_distance = std::numeric_limits<double>::infinity();
+
+	// Best readings by total distance, best first, with normalized scores
+	pi::LetterCandidates candidates;
+};
+
+struct PlateTextData
+{
+	std::vector<std::vector<LetterInfo>> plate_letters;
+	std::vector<std::string> plate_text;
+	std::vector<double> plate_confidence;
+};
+
+/*time spent in each stage of the pipeline, in milliseconds*/
+struct StageTimes
+{
+	double decode = 0.0;
+	double detect = 0.0;
+	double read = 0.0;
+};
+
+struct FrameResult
+{
+	PlateData plates;
+	PlateTextData text;
+	StageTimes times;  // Decoding is timed by the caller, it's the one reading the image
+};
+
+/**************************************************************************************************/
+/*                                     Public Functions                                          */
+/**************************************************************************************************/
+
+/**
+ * \brief Function that turns the debug windows opened by the pipeline on or off, they are on by default
+ */
+void set_debug_windows(bool enabled);
+
+FontData initialize_font();
+
+#ifdef PI_EMBEDDED_FONT
+/**
+ * \brief Function that wraps the font compiled into EmbeddedFont.hpp, nothing is read or decoded
+ */
+bool load_embedded_font(FontData& fontData);
+#endif
+
+/**
+ * \brief Function that trains a letter classifier on distorted copies of the font glyphs and writes its weights
+ */
+bool train_classifier(const FontData& fontData, const std::string& path, const pi::AugmentSettings& augment, const pi::TrainSettings& train);
+
+/**
+ * \brief Function that finds, scores and rectifies the license plates of an image
+ *
+ * \note With regions set, each one is searched as an image of its own and the plates are put back in image coordinates
+ */
+PlateData detect_plate(const FontData& fontData, const cv::Mat& sample, const DetectionSettings& settings);
+
+/**
+ * \brief Function that reads one letter against the given fonts, or with the classifier if the settings have one
+ */
+LetterInfo read_letter(const std::vector<const FontData*>& fonts, const cv::Mat& letter, const ReadSettings& settings, int class_mask = pi::CharAny);
+
+/**
+ * \brief Function that segments and reads the plates of several frames, all of their letters compared in one pass
+ */
+std::vector<PlateTextData> detect_and_read_text_batch(const FontData& fontData, const std::vector<PlateData>& frames, const ReadSettings& settings);
+
+/**
+ * \brief Function that gives the confidence a reading would have with the candidates of another one, read from the same letters
+ */
+double rescore_reading(const std::vector<LetterInfo>& letterList, const std::string& text, const pi::ConfidenceSettings& settings);
+
+/**
+ * \brief Function that segments and reads every plate found by detect_plate()
+ */
+PlateTextData detect_and_read_text(const FontData& fontData, const PlateData& plateData, const ReadSettings& settings);
+
+/**
+ * \brief Function that runs detect_plate() and detect_and_read_text() on one image, timing both
+ */
+FrameResult process_frame(const FontData& fontData, const cv::Mat& frame, const DetectionSettings& detection, const ReadSettings& read);
+
+/**
+ * \brief Function that quotes and escapes a string for JSON
+ */
+std::string json_string(const std::string& text);
+
+/**
+ * \brief Function that writes the plates of a frame as a JSON array, with their format, box, corners, text and confidences
+ */
+std::string plates_to_json(const FrameResult& result);
@@ -0,0 +1,164 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "PlateSpec.hpp"
+#include "Constants.hpp"
+
+namespace pi {
+
+	void PlateSpecRegistry::Add(const PlateSpec& spec) {
+		specs.push_back(spec);
+	}
+
+	bool PlateSpecRegistry::SetActive(const std::string& name, bool active) {
+		bool found = false;
+
+		for (auto& spec : specs) {
+			if (spec.name == name) {
+				spec.active = active;
+				found = true;
+			}
+		}
+
+		return found;
+	}
+
+	bool PlateSpecRegistry::ActivateOnly(const std::string& names) {
+		for (auto& spec : specs) {
+			spec.active = false;
+		}
+
+		bool all_found = true;
+
+		std::stringstream stream(names);
+		std::string name;
+
+		while (std::getline(stream, name, ',')) {
+			if (!name.empty() && !SetActive(name, true)) {
+				std::cout << "Unknown plate format " << name << std::endl;
+				all_found = false;
+			}
+		}
+
+		return all_found;
+	}
+
+	const std::vector<PlateSpec>& PlateSpecRegistry::Specs() const {
+		return specs;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	PlateSpec makePlateSpec(const std::string& name, double width, double height,
+		double ratio_lower, double ratio_higher, double cos_thresh, bool active)
+	{
+		PlateSpec spec;
+
+		spec.name = name;
+		spec.width = width;
+		spec.height = height;
+		spec.ratio_lower = ratio_lower;
+		spec.ratio_higher = ratio_higher;
+		spec.cos_thresh = cos_thresh;
+		spec.active = active;
+
+		// The edge ratio must be within [target * (1 + lower) ; target * (1 + higher)]
+		// Comparing squared lengths against squared bounds gives the same answer without any sqrt
+
+		double target_ratio = width / height;
+		double ratio_min = target_ratio * (1.0 + ratio_lower);
+		double ratio_max = target_ratio * (1.0 + ratio_higher);
+
+		spec.ratio2_min = ratio_min * ratio_min;
+		spec.ratio2_max = ratio_max * ratio_max;
+		spec.cos2_max = cos_thresh * cos_thresh;
+
+		spec.canonical_size = cv::Size((int)std::round(pi::plate_height * target_ratio), pi::plate_height);
+
+		return spec;
+	}
+
+	PlateSpecRegistry& defaultPlateSpecs() {
+		static PlateSpecRegistry registry = []() {
+			PlateSpecRegistry result;
+
+			// EU keeps the original 40:9 proportions and tolerances
+			result.Add(makePlateSpec("EU", 40.0, 9.0, -0.25, 0.35, 0.22, true));
+
+			// US plates are 12 x 6 inches
+			result.Add(makePlateSpec("US", 12.0, 6.0, -0.2, 0.2, 0.22, false));
+
+			// Square motorcycle plates, the reverse ratio covers the ones that are slightly taller
+			result.Add(makePlateSpec("MOTO", 1.0, 1.0, -0.1, 0.2, 0.22, false));
+
+			return result;
+		}();
+
+		return registry;
+	}
+
+	int matchPlateSpec(const std::vector<cv::Point>& points, const std::vector<PlateSpec>& specs) {
+		if (points.size() != 4) {
+			return -1;  // Can't be a rectangle to begin with
+		}
+
+		cv::Point ab = points[1] - points[0];
+		cv::Point bc = points[2] - points[1];
+		cv::Point cd = points[3] - points[2];
+		cv::Point da = points[0] - points[3];
+
+		double ab_len2 = ab.ddot(ab);
+		double bc_len2 = bc.ddot(bc);
+		double cd_len2 = cd.ddot(cd);
+		double da_len2 = da.ddot(da);
+
+		if (ab_len2 == 0.0 || bc_len2 == 0.0 || cd_len2 == 0.0 || da_len2 == 0.0) {
+			return -1;  // Degenerate quadrilateral
+		}
+
+		// |cos| > thresh  <=>  dot^2 > thresh^2 * |u|^2 * |v|^2
+		// The sign of the dot product doesn't matter once squared
+
+		double b_dot = ab.ddot(bc);
+		double c_dot = bc.ddot(cd);
+		double d_dot = cd.ddot(da);
+		double a_dot = da.ddot(ab);
+
+		double b_dot2 = b_dot * b_dot, b_len4 = ab_len2 * bc_len2;
+		double c_dot2 = c_dot * c_dot, c_len4 = bc_len2 * cd_len2;
+		double d_dot2 = d_dot * d_dot, d_len4 = cd_len2 * da_len2;
+		double a_dot2 = a_dot * a_dot, a_len4 = da_len2 * ab_len2;
+
+		for (int index = 0; index < (int)specs.size(); index++) {
+			const PlateSpec& spec = specs[index];
+
+			if (!spec.active) {
+				continue;
+			}
+
+			bool bad_angles =
+				b_dot2 > spec.cos2_max * b_len4 ||
+				c_dot2 > spec.cos2_max * c_len4 ||
+				d_dot2 > spec.cos2_max * d_len4 ||
+				a_dot2 > spec.cos2_max * a_len4;
+
+			if (bad_angles) {
+				continue;
+			}
+
+			// We know it's a rectangle, so we just need adjacent edges
+
+			bool good_ratio =
+				(ab_len2 >= spec.ratio2_min * bc_len2 && ab_len2 <= spec.ratio2_max * bc_len2) ||
+				(bc_len2 >= spec.ratio2_min * ab_len2 && bc_len2 <= spec.ratio2_max * ab_len2);
+
+			if (good_ratio) {
+				return index;
+			}
+		}
+
+		return -1;
+	}
+}
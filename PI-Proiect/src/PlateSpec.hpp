@@ -0,0 +1,103 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*the geometry of a license plate format, with the thresholds already squared for the checks*/
+	struct PlateSpec {
+		std::string name;
+
+		// Physical proportions of the plate, only the ratio matters
+		double width = 1.0;
+		double height = 1.0;
+
+		// Allowed relative deviation from width / height, lower is negative
+		double ratio_lower = 0.0;
+		double ratio_higher = 0.0;
+
+		// Maximum |cos| between adjacent edges
+		double cos_thresh = 0.0;
+
+		bool active = true;
+
+		// Size of the plate after perspective rectification, the height is pi::plate_height
+		cv::Size canonical_size;
+
+		// Precomputed by pi::makePlateSpec()
+		double ratio2_min = 0.0;
+		double ratio2_max = 0.0;
+		double cos2_max = 0.0;
+	};
+
+	/*a list of plate formats, only the active ones are used by pi::matchPlateSpec()*/
+	class PlateSpecRegistry {
+	private:
+
+		std::vector<PlateSpec> specs;
+
+	public:
+
+		void Add(const PlateSpec& spec);
+
+		/**
+		 * \brief Function that turns a plate format on or off
+		 *
+		 * \param[out] returns false if no format has the given name
+		 */
+		bool SetActive(const std::string& name, bool active);
+
+		/**
+		 * \brief Function that activates only the formats from a comma separated list, such as "EU,MOTO"
+		 *
+		 * \param[out] returns false if any of the names is unknown, the unknown names are skipped
+		 */
+		bool ActivateOnly(const std::string& names);
+
+		const std::vector<PlateSpec>& Specs() const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that builds a plate format and precomputes its squared thresholds
+	 *
+	 * \param[in] width, height - proportions of the plate
+	 *
+	 * \param[in] ratio_lower, ratio_higher - allowed relative deviation of the edge ratio
+	 *
+	 * \param[in] cos_thresh - maximum |cos| of the corner angles
+	 */
+	PlateSpec makePlateSpec(const std::string& name, double width, double height,
+		double ratio_lower, double ratio_higher, double cos_thresh, bool active = true);
+
+	/**
+	 * \brief Function that returns the registry used by pi::isLikeALicensePlate()
+	 *
+	 * \note Holds the EU, US and MOTO (square motorcycle) formats, only EU is active by default
+	 */
+	PlateSpecRegistry& defaultPlateSpecs();
+
+	/**
+	 * \brief Function that finds the first active plate format matched by a quadrilateral
+	 *
+	 * \param[in] points - the four corners of the candidate
+	 *
+	 * \param[in] specs - the plate formats to test
+	 *
+	 * \param[out] returns the index of the matching format in specs, or -1
+	 *
+	 * \note Only squared lengths and dot products are used, no square roots or divisions
+	 */
+	int matchPlateSpec(const std::vector<cv::Point>& points, const std::vector<PlateSpec>& specs);
+}
@@ -25,9 +25,12 @@
 #include <iomanip>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <chrono>
 
 /****************************
 *      Helper.cpp			*
 *****************************/
 #include <vector>
+#include <tuple>
 #include <opencv2/core.hpp>
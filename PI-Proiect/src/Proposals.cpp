@@ -0,0 +1,101 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Proposals.hpp"
+#include "PlateSpec.hpp"
+
+namespace pi {
+
+	cv::Mat verticalEdgeIntegral(const cv::Mat& gray, int edge_thresh) {
+		cv::Mat dx;
+		cv::Sobel(gray, dx, CV_16S, 1, 0, 3);
+
+		// Characters are mostly vertical strokes, the horizontal derivative picks them up
+
+		cv::Mat edges;
+		cv::convertScaleAbs(dx, edges);
+		cv::threshold(edges, edges, edge_thresh, 1, cv::THRESH_BINARY);
+
+		cv::Mat integral;
+		cv::integral(edges, integral, CV_32S);
+
+		return integral;
+	}
+
+	std::vector<PlateCandidate> proposeEdgeWindows(const cv::Mat& gray, const ProposalSettings& settings) {
+		cv::Mat integral = verticalEdgeIntegral(gray, settings.edge_thresh);
+
+		std::vector<PlateCandidate> windows;
+
+		const std::vector<PlateSpec>& specs = pi::defaultPlateSpecs().Specs();
+
+		for (int spec_index = 0; spec_index < (int)specs.size(); spec_index++) {
+			const PlateSpec& spec = specs[spec_index];
+
+			if (!spec.active) {
+				continue;
+			}
+
+			double ratio = spec.width / spec.height;
+
+			for (double scale : settings.scales) {
+				int height = (int)std::round(gray.rows * scale);
+				int width = (int)std::round(height * ratio);
+
+				if (height < 4 || width > gray.cols || height > gray.rows) {
+					continue;
+				}
+
+				int step_x = std::max(2, (int)(width * settings.stride_x));
+				int step_y = std::max(2, (int)(height * settings.stride_y));
+
+				double area = (double)width * height;
+
+				for (int y = 0; y + height <= gray.rows; y += step_y) {
+					const int* top = integral.ptr<int>(y);
+					const int* bottom = integral.ptr<int>(y + height);
+
+					for (int x = 0; x + width <= gray.cols; x += step_x) {
+						int count = bottom[x + width] - bottom[x] - top[x + width] + top[x];
+						double density = count / area;
+
+						if (density < settings.min_density) {
+							continue;
+						}
+
+						PlateCandidate window;
+						window.box = cv::Rect(x, y, width, height);
+						window.edge_density = density;
+						window.score = density;
+						window.spec_index = spec_index;
+
+						windows.push_back(window);
+					}
+				}
+			}
+		}
+
+		// Neighbouring windows over the same plate all pass, keep the densest ones before the expensive scoring
+
+		CandidateSettings window_settings;
+		window_settings.top_k = settings.max_proposals;
+		window_settings.iou_thresh = 0.3;
+
+		windows = pi::suppressNonMaximum(std::move(windows), window_settings);
+
+		// Windows have the exact proportions of their format, there is nothing left for pi::isLikeALicensePlate() to check
+
+		for (auto& window : windows) {
+			cv::Rect& box = window.box;
+
+			window.contour = {
+				box.tl(),
+				cv::Point(box.x + box.width, box.y),
+				box.br(),
+				cv::Point(box.x, box.y + box.height)
+			};
+		}
+
+		return windows;
+	}
+}
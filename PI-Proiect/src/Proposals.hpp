@@ -0,0 +1,58 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Candidates.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*parameters for the sliding window plate proposals*/
+	struct ProposalSettings {
+		// Window heights, as fractions of the image height
+		std::vector<double> scales = { 0.05, 0.075, 0.1, 0.15 };
+
+		// Step between windows, as fractions of the window size
+		double stride_x = 0.125;
+		double stride_y = 0.25;
+
+		// Minimum ratio of vertical edge pixels inside a window
+		double min_density = 0.15;
+
+		// Gradient magnitude above which a pixel counts as a vertical edge
+		int edge_thresh = 80;
+
+		// Number of windows handed over to the full candidate scoring
+		int max_proposals = 32;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that builds the integral image of the vertical edges of an image
+	 *
+	 * \param[in] gray - grayscale image
+	 *
+	 * \param[out] integral - CV_32S integral image of the binary vertical edge map, one row and column larger than gray
+	 */
+	cv::Mat verticalEdgeIntegral(const cv::Mat& gray, int edge_thresh);
+
+	/**
+	 * \brief Function that proposes plate shaped windows dense in vertical edges
+	 *
+	 * \param[in] gray - grayscale image
+	 *
+	 * \param[out] result - candidates with a 4-point contour and the format they were sized for
+	 *
+	 * \note Windows are scanned for every active plate format at a few scales, each one costs four lookups
+	 */
+	std::vector<PlateCandidate> proposeEdgeWindows(const cv::Mat& gray, const ProposalSettings& settings);
+}
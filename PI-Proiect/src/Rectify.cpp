@@ -0,0 +1,141 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Rectify.hpp"
+
+namespace pi {
+
+	WarpCache::WarpCache(size_t capacity) : capacity(capacity) {}
+
+	WarpMaps WarpCache::Get(const std::array<cv::Point, 4>& corners, cv::Size size) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			for (auto it = entries.begin(); it != entries.end(); it++) {
+				if (it->corners == corners && it->size == size) {
+					// Move to the front, so that the least recently used entry is always last
+					entries.splice(entries.begin(), entries, it);
+					return entries.front().maps;
+				}
+			}
+		}
+
+		// Build outside of the lock, another thread might do the same work but the result is identical
+
+		WarpMaps maps = buildWarpMaps(corners, size);
+
+		std::lock_guard<std::mutex> guard(lock);
+
+		entries.push_front(Entry{ corners, size, maps });
+
+		while (entries.size() > capacity) {
+			entries.pop_back();
+		}
+
+		return maps;
+	}
+
+	void WarpCache::Clear() {
+		std::lock_guard<std::mutex> guard(lock);
+		entries.clear();
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	std::array<cv::Point, 4> orderCorners(const std::vector<cv::Point>& quad) {
+		// Going by angle around the centroid keeps the four corners distinct, even for quads turned by about 45 degrees
+		// With y pointing down, increasing angles run clockwise on screen
+
+		cv::Point2d center(0.0, 0.0);
+
+		for (int i = 0; i < 4; i++) {
+			center += cv::Point2d(quad[i]);
+		}
+
+		center *= 0.25;
+
+		std::array<cv::Point, 4> corners = { quad[0], quad[1], quad[2], quad[3] };
+
+		std::sort(corners.begin(), corners.end(), [&](const cv::Point& left, const cv::Point& right) {
+			return std::atan2(left.y - center.y, left.x - center.x) < std::atan2(right.y - center.y, right.x - center.x);
+		});
+
+		// Top-left, the smallest x + y, goes first
+
+		int first = 0;
+
+		for (int i = 1; i < 4; i++) {
+			int sum = corners[i].x + corners[i].y, best = corners[first].x + corners[first].y;
+
+			if (sum < best || (sum == best && corners[i].x < corners[first].x)) {
+				first = i;
+			}
+		}
+
+		std::rotate(corners.begin(), corners.begin() + first, corners.end());
+
+		return corners;
+	}
+
+	WarpMaps buildWarpMaps(const std::array<cv::Point, 4>& corners, cv::Size size) {
+		cv::Point2f source[4];
+		cv::Point2f destination[4] = {
+			cv::Point2f(0.0f, 0.0f),
+			cv::Point2f(size.width - 1.0f, 0.0f),
+			cv::Point2f(size.width - 1.0f, size.height - 1.0f),
+			cv::Point2f(0.0f, size.height - 1.0f)
+		};
+
+		for (int i = 0; i < 4; i++) {
+			source[i] = cv::Point2f((float)corners[i].x, (float)corners[i].y);
+		}
+
+		// Maps every pixel of the canonical plate back into the source image
+
+		cv::Mat transform = cv::getPerspectiveTransform(destination, source);
+		const double* h = transform.ptr<double>();
+
+		cv::Mat coordinates(size, CV_32FC2);
+
+		for (int y = 0; y < size.height; y++) {
+			cv::Vec2f* row = coordinates.ptr<cv::Vec2f>(y);
+
+			for (int x = 0; x < size.width; x++) {
+				double w = h[6] * x + h[7] * y + h[8];
+				double scale = w != 0.0 ? 1.0 / w : 0.0;
+
+				row[x][0] = (float)((h[0] * x + h[1] * y + h[2]) * scale);
+				row[x][1] = (float)((h[3] * x + h[4] * y + h[5]) * scale);
+			}
+		}
+
+		// The fixed point format is what cv::remap uses internally, converting it once saves time on every call
+
+		WarpMaps maps;
+		cv::convertMaps(coordinates, cv::noArray(), maps.map1, maps.map2, CV_16SC2);
+
+		return maps;
+	}
+
+	WarpCache& defaultWarpCache() {
+		static WarpCache cache;
+		return cache;
+	}
+
+	cv::Mat rectifyPlate(const cv::Mat& image, const std::vector<cv::Point>& quad, cv::Size size, WarpCache* cache) {
+		if (quad.size() != 4) {
+			throw std::runtime_error("Plates can only be rectified from four corners.");
+		}
+
+		std::array<cv::Point, 4> corners = orderCorners(quad);
+
+		WarpMaps maps = cache != nullptr ? cache->Get(corners, size) : buildWarpMaps(corners, size);
+
+		cv::Mat plate;
+		cv::remap(image, plate, maps.map1, maps.map2, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+
+		return plate;
+	}
+}
@@ -0,0 +1,98 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+#include <array>
+#include <list>
+#include <mutex>
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*remap tables that warp a plate quadrilateral into a canonical rectangle*/
+	struct WarpMaps {
+		cv::Mat map1;  // Fixed point coordinates, CV_16SC2
+		cv::Mat map2;  // Interpolation table indices, CV_16UC1
+	};
+
+	/*a small LRU cache of warp maps, keyed by the plate corners and the output size*/
+	class WarpCache {
+	private:
+
+		struct Entry {
+			std::array<cv::Point, 4> corners;
+			cv::Size size;
+			WarpMaps maps;
+		};
+
+		std::list<Entry> entries;
+		size_t capacity;
+		std::mutex lock;
+
+	public:
+
+		WarpCache(size_t capacity = 32);
+		WarpCache(WarpCache&) = delete;
+		WarpCache(WarpCache&&) = delete;
+
+		/**
+		 * \brief Function that returns the warp maps for the given geometry, building them on a miss
+		 *
+		 * \param[in] corners - plate corners ordered top-left, top-right, bottom-right, bottom-left
+		 *
+		 * \param[in] size - the size of the rectified plate
+		 */
+		WarpMaps Get(const std::array<cv::Point, 4>& corners, cv::Size size);
+
+		void Clear();
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that orders the corners of a quadrilateral
+	 *
+	 * \param[in] quad - vector containing four points in any order, only the first four are used
+	 *
+	 * \param[out] corners - top-left, top-right, bottom-right, bottom-left
+	 */
+	std::array<cv::Point, 4> orderCorners(const std::vector<cv::Point>& quad);
+
+	/**
+	 * \brief Function that builds the remap tables for a 4-point perspective transform
+	 *
+	 * \param[in] corners - plate corners ordered as returned by pi::orderCorners()
+	 *
+	 * \param[in] size - the size of the rectified plate
+	 */
+	WarpMaps buildWarpMaps(const std::array<cv::Point, 4>& corners, cv::Size size);
+
+	/**
+	 * \brief Function that returns the warp cache shared by the plate detection
+	 */
+	WarpCache& defaultWarpCache();
+
+	/**
+	 * \brief Function that warps a plate into a rectangle of fixed size
+	 *
+	 * \param[in] image - the image containing the plate
+	 *
+	 * \param[in] quad - the four corners of the plate
+	 *
+	 * \param[in] size - the canonical size of the plate
+	 *
+	 * \param[in] cache - warp maps are taken from here if not null
+	 *
+	 * \param[out] plate - the rectified plate, of the given size
+	 */
+	cv::Mat rectifyPlate(const cv::Mat& image, const std::vector<cv::Point>& quad, cv::Size size, WarpCache* cache = nullptr);
+}
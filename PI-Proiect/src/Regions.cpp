@@ -0,0 +1,191 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Regions.hpp"
+#include "MappedFile.hpp"
+
+#include <charconv>
+
+namespace pi {
+
+	namespace {
+		bool isBlank(char c) {
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		const char* skipBlanks(const char* position, const char* end) {
+			while (position < end && isBlank(*position)) {
+				position++;
+			}
+
+			return position;
+		}
+
+		// Parses one integer, it has to be followed by a blank or the end of the line
+		bool parseInteger(const char*& position, const char* end, int& value) {
+			position = skipBlanks(position, end);
+
+			auto result = std::from_chars(position, end, value);
+
+			if (result.ec != std::errc() || (result.ptr < end && !isBlank(*result.ptr))) {
+				return false;
+			}
+
+			position = result.ptr;
+
+			return true;
+		}
+	}
+
+	bool LetterRegion::HasMetrics() const {
+		return baseline >= 0 && advance >= 0;
+	}
+
+	bool FontMetrics::Valid() const {
+		return min_width > 0.0 && max_width >= min_width && advance > 0.0;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	bool parseLetterRegions(const char* begin, const char* end, std::unordered_map<char, LetterRegion>& regions, std::string& error) {
+		regions.clear();
+
+		int number = 0;
+
+		for (const char* line = begin; line < end; ) {
+			const char* line_end = std::find(line, end, '\n');
+			const char* next = line_end < end ? line_end + 1 : end;
+
+			number++;
+
+			auto fail = [&](const std::string& message) {
+				std::string text(line, line_end);
+
+				if (!text.empty() && text.back() == '\r') {
+					text.pop_back();
+				}
+
+				error = "line " + std::to_string(number) + ": " + message + " in \"" + text + "\"";
+				return false;
+			};
+
+			const char* position = skipBlanks(line, line_end);
+
+			if (position == line_end || *position == '#') {
+				line = next;
+				continue;
+			}
+
+			// A single character, then at least one blank
+
+			char letter = *position++;
+
+			if (position < line_end && !isBlank(*position)) {
+				return fail("expected a single character");
+			}
+
+			LetterRegion region;
+			int values[6];
+			int count = 0;
+
+			while (count < 6 && skipBlanks(position, line_end) < line_end) {
+				if (!parseInteger(position, line_end, values[count])) {
+					return fail("expected an integer at column " + std::to_string(skipBlanks(position, line_end) - line + 1));
+				}
+
+				count++;
+			}
+
+			if (skipBlanks(position, line_end) < line_end) {
+				return fail("unexpected text at column " + std::to_string(skipBlanks(position, line_end) - line + 1));
+			}
+
+			if (count != 4 && count != 6) {
+				return fail("expected 4 or 6 numbers, found " + std::to_string(count));
+			}
+
+			region.rect = cv::Rect(values[0], values[1], values[2], values[3]);
+
+			if (region.rect.x < 0 || region.rect.y < 0 || region.rect.width <= 0 || region.rect.height <= 0) {
+				return fail("negative position or empty size");
+			}
+
+			if (count == 6) {
+				region.baseline = values[4];
+				region.advance = values[5];
+
+				if (region.baseline < 0 || region.advance < 0) {
+					return fail("negative baseline or advance");
+				}
+			}
+
+			if (!regions.emplace(letter, region).second) {
+				return fail(std::string("glyph '") + letter + "' is listed twice");
+			}
+
+			line = next;
+		}
+
+		return true;
+	}
+
+	std::unordered_map<char, LetterRegion> loadLetterRegions(const std::string& path) {
+		std::unordered_map<char, LetterRegion> regions;
+
+		MappedFile file;
+
+		if (!file.Open(path)) {
+			std::cout << "Failed to open file " << path << std::endl;
+			return regions;
+		}
+
+		const char* data = (const char*)file.Data();
+		std::string error;
+
+		if (!parseLetterRegions(data, data + file.Size(), regions, error)) {
+			std::cout << "Failed to read file " << path << ", " << error << std::endl;
+			regions.clear();
+		}
+
+		return regions;
+	}
+
+	FontMetrics fontMetrics(const std::unordered_map<char, LetterRegion>& regions) {
+		FontMetrics metrics;
+
+		std::vector<int> ascents, advances;
+
+		for (auto& pair : regions) {
+			if (!pair.second.HasMetrics() || pair.second.baseline == 0) {
+				return metrics;
+			}
+
+			ascents.push_back(pair.second.baseline);
+			advances.push_back(pair.second.advance);
+		}
+
+		if (ascents.empty()) {
+			return metrics;
+		}
+
+		// Glyphs with descenders are taller than the rest, the part above the baseline is the same for all of them
+
+		std::nth_element(ascents.begin(), ascents.begin() + ascents.size() / 2, ascents.end());
+		std::nth_element(advances.begin(), advances.begin() + advances.size() / 2, advances.end());
+
+		double ascent = ascents[ascents.size() / 2];
+
+		metrics.min_width = std::numeric_limits<double>::infinity();
+
+		for (auto& pair : regions) {
+			metrics.min_width = std::min(metrics.min_width, pair.second.rect.width / ascent);
+			metrics.max_width = std::max(metrics.max_width, pair.second.rect.width / ascent);
+		}
+
+		metrics.advance = advances[advances.size() / 2] / ascent;
+
+		return metrics;
+	}
+}
@@ -0,0 +1,68 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*where a glyph is in the font sample, with its metrics when the regions file has them*/
+	struct LetterRegion {
+		cv::Rect rect;
+
+		// Row of the baseline and horizontal advance, both relative to rect, -1 when not given
+		int baseline = -1;
+		int advance = -1;
+
+		bool HasMetrics() const;
+	};
+
+	/*proportions of a font, relative to the height of its glyphs above the baseline*/
+	struct FontMetrics {
+		double min_width = 0.0;  // Narrowest glyph
+		double max_width = 0.0;  // Widest glyph
+		double advance = 0.0;    // Median step from the start of a glyph to the start of the next one
+
+		bool Valid() const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that parses a regions file held in memory
+	 *
+	 * \param[in] begin, end - the whole file, it doesn't need to end with a new line
+	 *
+	 * \param[out] regions - one entry per glyph
+	 *
+	 * \param[out] error - line number and description of the first malformed line
+	 *
+	 * \param[out] returns false on the first malformed line or repeated glyph, regions then holds the lines before it
+	 *
+	 * \note One glyph per line, blank lines and lines starting with '#' are skipped:
+	 *       <char> <x> <y> <width> <height> [<baseline> <advance>]
+	 */
+	bool parseLetterRegions(const char* begin, const char* end, std::unordered_map<char, LetterRegion>& regions, std::string& error);
+
+	/**
+	 * \brief Function that maps a regions file and parses it
+	 *
+	 * \param[out] result - the glyph regions, empty if the file couldn't be opened or has a malformed line
+	 */
+	std::unordered_map<char, LetterRegion> loadLetterRegions(const std::string& path);
+
+	/**
+	 * \brief Function that summarizes the metrics of the glyphs of a font
+	 *
+	 * \param[out] result - invalid unless every glyph has its metrics, segmentation then falls back to guessing
+	 */
+	FontMetrics fontMetrics(const std::unordered_map<char, LetterRegion>& regions);
+}
@@ -0,0 +1,247 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "SharedFrames.hpp"
+
+#ifndef _WIN32
+
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	const char ring_magic[4] = { 'P', 'I', 'R', 'B' };
+
+	std::atomic<bool> stop_requested(false);
+
+	void request_stop(int)
+	{
+		stop_requested = true;
+	}
+
+	/*the mapped ring, unmapped when it goes out of scope*/
+	struct SharedRing
+	{
+		uint8_t* data = nullptr;
+		size_t size = BASE_VALUE;
+
+		// Geometry copied from the header once it was checked, the producer can't change it under us afterwards
+		uint32_t slots = BASE_VALUE;
+		uint32_t slot_size = BASE_VALUE;
+		uint32_t data_offset = BASE_VALUE;
+
+		~SharedRing()
+		{
+			if (data != nullptr)
+			{
+				munmap(data, size);
+			}
+		}
+
+		SharedRingHeader& Header() const
+		{
+			return *(SharedRingHeader*)data;
+		}
+
+		uint8_t* Slot(uint64_t sequence) const
+		{
+			return data + sizeof(SharedRingHeader) + (sequence % slots) * (size_t)slot_size;
+		}
+	};
+
+	bool open_ring(const std::string& name, SharedRing& ring)
+	{
+		int handle = shm_open(name.c_str(), O_RDWR, BASE_VALUE);
+
+		if (handle < 0)
+		{
+			std::cerr << "Failed to open shared memory " << name << std::endl;
+			return false;
+		}
+
+		struct stat status;
+
+		if (fstat(handle, &status) != BASE_VALUE || status.st_size < (off_t)sizeof(SharedRingHeader))
+		{
+			std::cerr << "Shared memory " << name << " is too small for a ring header" << std::endl;
+			close(handle);
+			return false;
+		}
+
+		void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, BASE_VALUE);
+		close(handle);
+
+		if (data == MAP_FAILED)
+		{
+			std::cerr << "Failed to map shared memory " << name << std::endl;
+			return false;
+		}
+
+		ring.data = (uint8_t*)data;
+		ring.size = (size_t)status.st_size;
+
+		const SharedRingHeader& header = ring.Header();
+
+		uint32_t slots = header.slots;
+		uint32_t slot_size = header.slot_size;
+		uint32_t data_offset = header.data_offset;
+
+		if (std::memcmp(header.magic, ring_magic, sizeof(ring_magic)) != BASE_VALUE || header.version != SHARED_RING_VERSION)
+		{
+			std::cerr << "Shared memory " << name << " doesn't hold a version " << SHARED_RING_VERSION << " frame ring" << std::endl;
+			return false;
+		}
+
+		// Slots must stay 8 byte aligned for their headers
+
+		if (slots == BASE_VALUE || data_offset < sizeof(SharedSlotHeader) || slot_size < data_offset || slot_size % 8 != BASE_VALUE ||
+			sizeof(SharedRingHeader) + (uint64_t)slots * slot_size > ring.size)
+		{
+			std::cerr << "Shared memory " << name << " has an inconsistent ring header" << std::endl;
+			return false;
+		}
+
+		ring.slots = slots;
+		ring.slot_size = slot_size;
+		ring.data_offset = data_offset;
+
+		return true;
+	}
+}
+
+bool run_shared_frames(const FontData& fontData, const std::string& name,
+	const DetectionSettings& detection, const ReadSettings& read, const SharedFrameSettings& settings)
+{
+	SharedRing ring;
+
+	if (!open_ring(name, ring))
+	{
+		return false;
+	}
+
+	std::ofstream file;
+
+	if (!settings.output.empty())
+	{
+		file.open(settings.output);
+
+		if (!file.good())
+		{
+			std::cerr << "Failed to open " << settings.output << std::endl;
+			return false;
+		}
+	}
+
+	std::ostream& output = settings.output.empty() ? std::cout : file;
+
+	stop_requested = false;
+
+	std::signal(SIGINT, request_stop);
+	std::signal(SIGTERM, request_stop);
+
+	SharedRingHeader& header = ring.Header();
+
+	pi::WarpCache warp_cache;
+
+	DetectionSettings frame_detection = detection;
+	frame_detection.warp_cache = &warp_cache;
+	frame_detection.draw = false;
+
+	// Frames released before we started belong to an earlier consumer, carry on after them
+
+	uint64_t next = header.released_sequence.load(std::memory_order_acquire);
+
+	int64_t processed = BASE_VALUE;
+	int64_t skipped = BASE_VALUE;
+	int64_t invalid = BASE_VALUE;
+
+	double total_ms = 0.0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	while (!stop_requested)
+	{
+		uint64_t published = header.published_sequence.load(std::memory_order_acquire);
+
+		if (published <= next)
+		{
+			if (header.closed.load(std::memory_order_acquire) != BASE_VALUE)
+			{
+				break;
+			}
+
+			std::this_thread::sleep_for(std::chrono::microseconds(settings.poll_interval));
+			continue;
+		}
+
+		// Behind the producer, the older frames are given back unread so it never waits on them
+
+		if (settings.skip_stale && published - next > 1)
+		{
+			skipped += published - 1 - next;
+			next = published - 1;
+
+			header.released_sequence.store(next, std::memory_order_release);
+		}
+
+		// Copied so the checks below hold for the frame that is read
+
+		SharedSlotHeader slot = *(const SharedSlotHeader*)ring.Slot(next);
+		uint8_t* pixels = ring.Slot(next) + ring.data_offset;
+
+		bool valid = slot.sequence == next && slot.width > BASE_VALUE && slot.height > BASE_VALUE &&
+			slot.stride >= (uint64_t)slot.width * 3 &&
+			(uint64_t)slot.stride * (slot.height - 1) + (uint64_t)slot.width * 3 <= ring.slot_size - ring.data_offset;
+
+		if (valid)
+		{
+			// The frame is the slot itself, it's only released once nothing refers to it anymore
+
+			cv::Mat frame((int)slot.height, (int)slot.width, CV_8UC3, pixels, (size_t)slot.stride);
+
+			FrameResult result = process_frame(fontData, frame, frame_detection, read);
+
+			total_ms += result.times.detect + result.times.read;
+			processed++;
+
+			output << "{\"sequence\":" << next << ",\"timestamp_ns\":" << slot.timestamp_ns
+				<< ",\"width\":" << slot.width << ",\"height\":" << slot.height
+				<< ",\"plates\":" << plates_to_json(result)
+				<< ",\"ms\":{\"detect\":" << result.times.detect << ",\"read\":" << result.times.read << "}}\n";
+		}
+		else
+		{
+			invalid++;
+		}
+
+		next++;
+
+		header.released_sequence.store(next, std::memory_order_release);
+	}
+
+	output.flush();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << "Processed " << processed << " shared frames, skipped " << skipped << ", invalid " << invalid
+		<< " in " << seconds << " s, " << processed / std::max(seconds, 1e-9) << " frames/s, "
+		<< total_ms / std::max<int64_t>(processed, 1) << " ms per frame" << std::endl;
+
+	return true;
+}
+
+#else
+
+bool run_shared_frames(const FontData& fontData, const std::string& name,
+	const DetectionSettings& detection, const ReadSettings& read, const SharedFrameSettings& settings)
+{
+	std::cerr << "The shared memory input needs POSIX shared memory, it isn't available on this platform" << std::endl;
+	return false;
+}
+
+#endif
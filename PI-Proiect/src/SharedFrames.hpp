@@ -0,0 +1,82 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Pipeline.hpp"
+
+#include <atomic>
+
+/*************************************************************************************************/
+/*                                       Defines & types                                         */
+/*************************************************************************************************/
+
+#define SHARED_RING_VERSION 1
+
+/*
+ * Layout of the shared memory object, created and sized by the producer:
+ *
+ *   SharedRingHeader | slot 0 | slot 1 | ... | slot (slots - 1)
+ *
+ * Every slot starts with a SharedSlotHeader, its pixels follow at data_offset from the start of the slot
+ * Frame n goes to slot n % slots, the producer may only write it once released_sequence > n - slots
+ */
+
+/*header of the whole ring, all offsets in bytes*/
+struct SharedRingHeader
+{
+	char magic[4];                         // "PIRB"
+	uint32_t version;                      // SHARED_RING_VERSION
+	uint32_t slots;
+	uint32_t slot_size;                    // Distance between two slots, header included, a multiple of 8
+	uint32_t data_offset;                  // Offset of the pixels inside a slot
+	std::atomic<uint32_t> closed;          // Set by the producer when no more frames will come
+
+	alignas(64) std::atomic<uint64_t> published_sequence;  // Frames written so far, set by the producer after the slot
+	alignas(64) std::atomic<uint64_t> released_sequence;   // Frames the consumer is done with, set by this program
+};
+
+/*header of one slot, valid once published_sequence is past its frame*/
+struct SharedSlotHeader
+{
+	uint64_t sequence;       // Index of the frame held by the slot
+	uint64_t timestamp_ns;   // Capture time, in any clock of the producer
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;         // Bytes between two rows of BGR pixels
+	uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring sequences must be lock free to be shared between processes");
+
+struct SharedFrameSettings
+{
+	// Jump to the newest frame when more than one is waiting, the skipped ones are released unread
+	bool skip_stale = true;
+
+	// Sleep between two looks at the ring while it is empty, in microseconds
+	int poll_interval = 500;
+
+	// JSONL file the records go to, empty for the standard output
+	std::string output;
+};
+
+/**************************************************************************************************/
+/*                                     Public Functions                                          */
+/**************************************************************************************************/
+
+/**
+ * \brief Function that reads the plates of the BGR frames a producer process puts in a POSIX shared memory ring
+ *
+ * \param[in] name - name of the shared memory object, as given to shm_open()
+ *
+ * \param[out] returns false if the ring couldn't be opened or its header is wrong
+ *
+ * \note Frames are wrapped in place and released as soon as their plates are read, nothing is copied
+ *       Runs until the producer sets closed and the ring is empty, or until SIGINT or SIGTERM
+ *       Writes one JSON record per frame with its sequence and timestamp
+ */
+bool run_shared_frames(const FontData& fontData, const std::string& name,
+	const DetectionSettings& detection, const ReadSettings& read, const SharedFrameSettings& settings);
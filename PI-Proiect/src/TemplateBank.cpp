@@ -0,0 +1,322 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "TemplateBank.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace pi {
+
+	namespace {
+		// Pad every plane to a whole number of cache lines, so rows stay 64 byte aligned
+		const int plane_alignment = 16;
+
+		const double plane_scale[(int)TemplatePlane::Count] = { 1.0 / 255.0, 1.0 / 255.0 };
+
+		// Weights of each feature in the total distance, same as pi::compareGlyphs()
+		const double plane_weight[(int)TemplatePlane::Count] = { 0.6, 0.25 };
+		const double histogram_weight = 0.5;
+
+		// Number of floats summed between two checks of the bound
+		const int bound_check_block = 64;
+
+		// Templates compared together in pi::TemplateBank::BatchDistances(), 8 of them take about 70 KB
+		const int template_tile = 8;
+
+		void normalizePlane(const cv::Mat& source, float* destination, double scale) {
+			cv::Mat wrapper(source.rows, source.cols, CV_32F, destination);
+			source.convertTo(wrapper, CV_32F, scale);
+		}
+
+		int alignedSize(int size) {
+			return (size + plane_alignment - 1) / plane_alignment * plane_alignment;
+		}
+	}
+
+	void TemplateBank::Build(const std::unordered_map<char, pi::GlyphDescriptor>& glyphs) {
+		labels.clear();
+		aspects.clear();
+
+		for (auto& pair : glyphs) {
+			labels.push_back(pair.first);
+		}
+
+		std::sort(labels.begin(), labels.end());
+
+		zoning_stride = alignedSize(pi::zoning_dimension * pi::zoning_dimension);
+		zoning = cv::Mat::zeros((int)labels.size(), zoning_stride, CV_32F);
+		hog = cv::Mat::zeros((int)labels.size(), pi::hog_stride, CV_8U);
+
+		for (char label : labels) {
+			aspects.push_back(glyphs.at(label).aspect);
+		}
+
+		pixels = pi::glyph_size.area();
+		stride = alignedSize(pixels);
+
+		int count = (int)labels.size();
+		int planes = (int)TemplatePlane::Count;
+
+		// cv::Mat allocations are aligned, padding stays zero on both sides so it adds nothing to the distance
+		data = cv::Mat::zeros(planes * count, stride, CV_32F);
+
+		for (int index = 0; index < count; index++) {
+			const pi::GlyphDescriptor& glyph = glyphs.at(labels[index]);
+
+			normalizePlane(glyph.intensity, data.ptr<float>((int)TemplatePlane::Intensity * count + index), plane_scale[0]);
+			normalizePlane(glyph.grad.magnit, data.ptr<float>((int)TemplatePlane::Magnitude * count + index), plane_scale[1]);
+
+			normalizePlane(glyph.zoning, zoning.ptr<float>(index), 1.0);
+			glyph.hog.copyTo(hog.row(index));
+		}
+	}
+
+	bool TemplateBank::Wrap(const std::vector<char>& labels, const std::vector<double>& aspects, int stride, int zoning_stride,
+		const float* data, const float* zoning, const uint8_t* hog)
+	{
+		int pixels = pi::glyph_size.area();
+
+		if (stride != alignedSize(pixels) || zoning_stride != alignedSize(pi::zoning_dimension * pi::zoning_dimension) ||
+			labels.size() != aspects.size())
+		{
+			return false;
+		}
+
+		int count = (int)labels.size();
+
+		this->labels = labels;
+		this->aspects = aspects;
+		this->pixels = pixels;
+		this->stride = stride;
+		this->zoning_stride = zoning_stride;
+
+		// cv::Mat headers over foreign memory never free it, copies of the bank share it the same way
+
+		this->data = cv::Mat((int)TemplatePlane::Count * count, stride, CV_32F, (void*)data);
+		this->zoning = cv::Mat(count, zoning_stride, CV_32F, (void*)zoning);
+		this->hog = cv::Mat(count, pi::hog_stride, CV_8U, (void*)hog);
+
+		return true;
+	}
+
+	int TemplateBank::Size() const {
+		return (int)labels.size();
+	}
+
+	int TemplateBank::Stride() const {
+		return stride;
+	}
+
+	char TemplateBank::Label(int index) const {
+		return labels[index];
+	}
+
+	double TemplateBank::Aspect(int index) const {
+		return aspects[index];
+	}
+
+	int TemplateBank::ZoningStride() const {
+		return zoning_stride;
+	}
+
+	const float* TemplateBank::Zoning(int index) const {
+		return zoning.ptr<float>(index);
+	}
+
+	const float* TemplateBank::Plane(int index, TemplatePlane plane) const {
+		return data.ptr<float>((int)plane * Size() + index);
+	}
+
+	const uint8_t* TemplateBank::Histograms(int index) const {
+		return hog.ptr<uint8_t>(index);
+	}
+
+	NormalizedGlyph TemplateBank::Normalize(const pi::GlyphDescriptor& descriptor) const {
+		NormalizedGlyph unknown;
+		unknown.planes.assign((size_t)stride * (int)TemplatePlane::Count, 0.0f);
+
+		normalizePlane(descriptor.intensity, &unknown.planes[(size_t)stride * (int)TemplatePlane::Intensity], plane_scale[0]);
+		normalizePlane(descriptor.grad.magnit, &unknown.planes[(size_t)stride * (int)TemplatePlane::Magnitude], plane_scale[1]);
+
+		unknown.hog = descriptor.hog;
+
+		return unknown;
+	}
+
+	void TemplateBank::Distances(const NormalizedGlyph& unknown, std::vector<pi::GlyphDistance>& distances) const {
+		int count = Size();
+
+		distances.resize(count);
+
+		for (int index = 0; index < count; index++) {
+			Distance(unknown, index, std::numeric_limits<double>::infinity(), distances[index]);
+		}
+	}
+
+	void TemplateBank::BatchDistances(const std::vector<NormalizedGlyph>& unknowns, std::vector<pi::GlyphDistance>& distances) const {
+		int count = Size();
+		int letters = (int)unknowns.size();
+
+		distances.assign((size_t)letters * count, pi::GlyphDistance());
+
+		int tiles = (count + template_tile - 1) / template_tile;
+
+		// Every tile writes its own columns, so tiles can run on separate threads
+
+		cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range& range) {
+			for (int tile = range.start; tile < range.end; tile++) {
+				int first = tile * template_tile;
+				int last = std::min(first + template_tile, count);
+
+				for (int letter = 0; letter < letters; letter++) {
+					const NormalizedGlyph& unknown = unknowns[letter];
+					pi::GlyphDistance* row = &distances[(size_t)letter * count];
+
+					for (int index = first; index < last; index++) {
+						Distance(unknown, index, std::numeric_limits<double>::infinity(), row[index]);
+					}
+				}
+			}
+		});
+	}
+
+	bool TemplateBank::Distance(const NormalizedGlyph& unknown, int index, double bound, pi::GlyphDistance& distance) const {
+		double plane_distance[(int)TemplatePlane::Count] = { 0.0 };
+
+		distance.angle = pi::normalizedHistogramDistance(Histograms(index), unknown.hog.ptr<uint8_t>());
+
+		double total = distance.angle * histogram_weight;
+
+		if (total > bound) {
+			distance.total = total;
+			return false;
+		}
+
+		for (int plane = 0; plane < (int)TemplatePlane::Count; plane++) {
+			// Whatever is left of the bound, converted back to a raw sum for this plane
+
+			double limit = (bound - total) * pixels / plane_weight[plane];
+
+			double sum = sumSquaredDifferences(Plane(index, (TemplatePlane)plane), &unknown.planes[(size_t)stride * plane], stride, limit);
+
+			plane_distance[plane] = sum / pixels;
+			total += plane_distance[plane] * plane_weight[plane];
+
+			if (sum > limit) {
+				distance.total = total;
+				return false;
+			}
+		}
+
+		distance.value = plane_distance[(int)TemplatePlane::Intensity];
+		distance.magnitude = plane_distance[(int)TemplatePlane::Magnitude];
+		distance.total = total;
+
+		return true;
+	}
+
+	std::vector<int> TemplateBank::VisitOrder(double aspect, int class_mask) const {
+		std::vector<int> order;
+		std::vector<double> keys(labels.size());
+
+		for (int index = 0; index < (int)labels.size(); index++) {
+			if (!(pi::charClass(labels[index]) & class_mask)) {
+				continue;
+			}
+
+			order.push_back(index);
+			keys[index] = std::abs(std::log(std::max(aspect, 1e-3) / std::max(aspects[index], 1e-3)));
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](int left, int right) { return keys[left] < keys[right]; });
+
+		return order;
+	}
+
+	std::vector<int> TemplateBank::Shortlist(const pi::GlyphDescriptor& descriptor, int k, int class_mask) const {
+		std::vector<float> unknown(zoning_stride, 0.0f);
+		normalizePlane(descriptor.zoning, unknown.data(), 1.0);
+
+		std::vector<double> keys(Size());
+		std::vector<int> order;
+
+		for (int index = 0; index < Size(); index++) {
+			if (!(pi::charClass(labels[index]) & class_mask)) {
+				continue;
+			}
+
+			order.push_back(index);
+			keys[index] = sumSquaredDifferences(zoning.ptr<float>(index), unknown.data(), zoning_stride);
+		}
+
+		int count = (int)order.size();
+
+		auto closer = [&](int left, int right) { return keys[left] < keys[right] || (keys[left] == keys[right] && left < right); };
+
+		if (k <= 0 || k >= count) {
+			std::sort(order.begin(), order.end(), closer);
+			return order;
+		}
+
+		std::partial_sort(order.begin(), order.begin() + k, order.end(), closer);
+		order.resize(k);
+
+		return order;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	double sumSquaredDifferences(const float* left, const float* right, int count) {
+		int i = 0;
+		double sum = 0.0;
+
+#if CV_SIMD
+		// Two accumulators hide the latency of the multiply-add
+		// The values are in [0 ; 1], so float precision is plenty for a single glyph
+
+		cv::v_float32 acc0 = cv::vx_setzero_f32();
+		cv::v_float32 acc1 = cv::vx_setzero_f32();
+
+		const int lanes = cv::v_float32::nlanes;
+
+		for (; i <= count - 2 * lanes; i += 2 * lanes) {
+			cv::v_float32 diff0 = cv::vx_load(left + i) - cv::vx_load(right + i);
+			cv::v_float32 diff1 = cv::vx_load(left + i + lanes) - cv::vx_load(right + i + lanes);
+
+			acc0 = cv::v_fma(diff0, diff0, acc0);
+			acc1 = cv::v_fma(diff1, diff1, acc1);
+		}
+
+		sum = cv::v_reduce_sum(acc0 + acc1);
+
+		cv::vx_cleanup();
+#endif
+
+		for (; i < count; i++) {
+			double diff = (double)left[i] - right[i];
+			sum += diff * diff;
+		}
+
+		return sum;
+	}
+
+	double sumSquaredDifferences(const float* left, const float* right, int count, double limit) {
+		double sum = 0.0;
+
+		// The sum only grows, so once a block pushes it over the limit the rest can be skipped
+
+		for (int start = 0; start < count; start += bound_check_block) {
+			int block = std::min(bound_check_block, count - start);
+
+			sum += sumSquaredDifferences(left + start, right + start, block);
+
+			if (sum > limit) {
+				break;
+			}
+		}
+
+		return sum;
+	}
+}
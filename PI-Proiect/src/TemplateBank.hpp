@@ -0,0 +1,174 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Glyph.hpp"
+#include "Grammar.hpp"
+#include "Hog.hpp"
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*the feature planes stored for every template, the orientation is kept as histograms instead*/
+	enum class TemplatePlane {
+		Intensity = 0,
+		Magnitude = 1,
+		Count = 2
+	};
+
+	/*an unknown glyph in the same layout as the templates*/
+	struct NormalizedGlyph {
+		std::vector<float> planes;   // The planes one after the other, each of TemplateBank::Stride() floats
+		cv::Mat hog;                 // 1 x pi::hog_stride, CV_8U
+	};
+
+	/*all font glyphs resampled to pi::glyph_size and normalized to [0 ; 1], stored in one aligned block*/
+	class TemplateBank {
+	private:
+
+		std::vector<char> labels;
+		std::vector<double> aspects;
+
+		// (plane count * glyph count) rows of stride floats, plane p of glyph g is row (p * glyph count + g)
+		cv::Mat data;
+
+		int pixels = 0;
+		int stride = 0;
+
+		// One row of zoning_stride floats per glyph, the ink density grid flattened
+		cv::Mat zoning;
+		int zoning_stride = 0;
+
+		// One row of pi::hog_stride bytes per glyph
+		cv::Mat hog;
+
+	public:
+
+		/**
+		 * \brief Function that packs the glyph descriptors into the bank, ordered by character
+		 */
+		void Build(const std::unordered_map<char, pi::GlyphDescriptor>& glyphs);
+
+		/**
+		 * \brief Function that points the bank at templates laid out by another bank, without copying them
+		 *
+		 * \param[in] data, zoning, hog - blocks in the same layout as the ones filled by Build(), they must outlive the bank
+		 *
+		 * \param[out] returns false if the strides don't match the ones this build uses
+		 */
+		bool Wrap(const std::vector<char>& labels, const std::vector<double>& aspects, int stride, int zoning_stride,
+			const float* data, const float* zoning, const uint8_t* hog);
+
+		int Size() const;
+
+		/**
+		 * \brief Function that returns the number of floats per plane, a multiple of the SIMD width
+		 */
+		int Stride() const;
+
+		char Label(int index) const;
+
+		double Aspect(int index) const;
+
+		int ZoningStride() const;
+
+		const float* Plane(int index, TemplatePlane plane) const;
+
+		const uint8_t* Histograms(int index) const;
+
+		const float* Zoning(int index) const;
+
+		/**
+		 * \brief Function that normalizes a descriptor the same way as the templates
+		 *
+		 * \param[out] unknown - the planes and histograms of the descriptor
+		 */
+		NormalizedGlyph Normalize(const pi::GlyphDescriptor& descriptor) const;
+
+		/**
+		 * \brief Function that computes the distances of a normalized unknown glyph to every template
+		 *
+		 * \param[in] unknown - buffer returned by Normalize()
+		 *
+		 * \param[out] distances - Size() entries, same scale as pi::compareGlyphs()
+		 */
+		void Distances(const NormalizedGlyph& unknown, std::vector<pi::GlyphDistance>& distances) const;
+
+		/**
+		 * \brief Function that computes the distances of many unknown glyphs to every template at once
+		 *
+		 * \param[in] unknowns - buffers returned by Normalize(), from any number of plates or frames
+		 *
+		 * \param[out] distances - unknowns.size() x Size() entries, row major, same scale as pi::compareGlyphs()
+		 *
+		 * \note Templates are taken a few at a time and compared against every unknown glyph while they are
+		 *       still in cache, instead of streaming the whole bank once per letter
+		 */
+		void BatchDistances(const std::vector<NormalizedGlyph>& unknowns, std::vector<pi::GlyphDistance>& distances) const;
+
+		/**
+		 * \brief Function that computes the distance to one template, giving up once it exceeds a bound
+		 *
+		 * \param[in] unknown - buffer returned by Normalize()
+		 *
+		 * \param[in] bound - the total distance above which the template is of no interest
+		 *
+		 * \param[out] distance - the distance, only fully filled in if the function returns true
+		 *
+		 * \param[out] returns false if the comparison was cut short because the total went over the bound
+		 *
+		 * \note The histograms cost a few hundred byte operations, they are compared first and often settle it
+		 */
+		bool Distance(const NormalizedGlyph& unknown, int index, double bound, pi::GlyphDistance& distance) const;
+
+		/**
+		 * \brief Function that orders the templates from the most to the least likely match
+		 *
+		 * \param[in] aspect - width / height of the unknown letter before resampling
+		 *
+		 * \param[in] class_mask - pi::CharClass mask, templates of other classes are left out
+		 *
+		 * \note Comparing aspect ratios is cheap and puts the likely glyphs first, which tightens the bound early
+		 */
+		std::vector<int> VisitOrder(double aspect, int class_mask = pi::CharAny) const;
+
+		/**
+		 * \brief Function that picks the templates whose zoning features are closest to the unknown glyph
+		 *
+		 * \param[in] descriptor - the unknown glyph
+		 *
+		 * \param[in] k - number of templates to keep, all of them if k <= 0
+		 *
+		 * \param[in] class_mask - pi::CharClass mask, templates of other classes are left out
+		 *
+		 * \param[out] shortlist - template indices, closest first
+		 *
+		 * \note Costs one pi::zoning_dimension^2 comparison per template, much less than a full comparison
+		 */
+		std::vector<int> Shortlist(const pi::GlyphDescriptor& descriptor, int k, int class_mask = pi::CharAny) const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that calculates the sum of squared differences of two float arrays
+	 *
+	 * \note Uses the OpenCV universal intrinsics when available
+	 */
+	double sumSquaredDifferences(const float* left, const float* right, int count);
+
+	/**
+	 * \brief Function that calculates the sum of squared differences, stopping early once it exceeds a limit
+	 *
+	 * \param[out] returns the full sum, or a partial sum greater than limit if it stopped early
+	 */
+	double sumSquaredDifferences(const float* left, const float* right, int count, double limit);
+}
@@ -0,0 +1,282 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Tracker.hpp"
+#include "Candidates.hpp"
+#include "Confidence.hpp"
+
+namespace pi {
+
+	namespace {
+		const cv::Size thumbnail_size = cv::Size(64, 16);
+
+		// State is (center x, center y, width, height, velocity x, velocity y), measurements are the first four
+		void initKalman(cv::KalmanFilter& kalman, const cv::Rect& box) {
+			kalman.init(6, 4, 0, CV_32F);
+
+			cv::setIdentity(kalman.transitionMatrix);
+			kalman.transitionMatrix.at<float>(0, 4) = 1.0f;
+			kalman.transitionMatrix.at<float>(1, 5) = 1.0f;
+
+			kalman.measurementMatrix = cv::Mat::zeros(4, 6, CV_32F);
+
+			for (int i = 0; i < 4; i++) {
+				kalman.measurementMatrix.at<float>(i, i) = 1.0f;
+			}
+
+			cv::setIdentity(kalman.processNoiseCov, cv::Scalar::all(1.0));
+			cv::setIdentity(kalman.measurementNoiseCov, cv::Scalar::all(4.0));
+			cv::setIdentity(kalman.errorCovPost, cv::Scalar::all(10.0));
+
+			// Nothing is known about the speed yet
+			kalman.errorCovPost.at<float>(4, 4) = 100.0f;
+			kalman.errorCovPost.at<float>(5, 5) = 100.0f;
+
+			kalman.statePost = (cv::Mat_<float>(6, 1) <<
+				box.x + box.width / 2.0f, box.y + box.height / 2.0f, (float)box.width, (float)box.height, 0.0f, 0.0f);
+		}
+
+		cv::Mat boxMeasurement(const cv::Rect& box) {
+			return (cv::Mat_<float>(4, 1) << box.x + box.width / 2.0f, box.y + box.height / 2.0f, (float)box.width, (float)box.height);
+		}
+
+		cv::Rect stateBox(const cv::Mat& state) {
+			float cx = state.at<float>(0), cy = state.at<float>(1);
+			float width = std::max(state.at<float>(2), 1.0f), height = std::max(state.at<float>(3), 1.0f);
+
+			return cv::Rect(cvRound(cx - width / 2.0f), cvRound(cy - height / 2.0f), cvRound(width), cvRound(height));
+		}
+
+		double appearanceChange(const cv::Mat& left, const cv::Mat& right) {
+			if (left.empty() || right.empty()) {
+				return 1.0;
+			}
+
+			return cv::norm(left, right, cv::NORM_L1) / (255.0 * left.total());
+		}
+
+		// Picks the best character of every position, and how much of the votes it got
+		void tallyVotes(PlateTrack& track, const PlateGrammar* grammar) {
+			double best_weight = -1.0;
+			const std::vector<std::map<char, double>>* best = nullptr;
+
+			// The letter count most of the weight agrees on wins
+
+			for (auto& pair : track.votes) {
+				double weight = 0.0;
+
+				for (auto& position : pair.second) {
+					for (auto& vote : position) {
+						weight += vote.second;
+					}
+				}
+
+				if (weight > best_weight) {
+					best_weight = weight;
+					best = &pair.second;
+				}
+			}
+
+			track.text.clear();
+			track.letter_confidence.clear();
+
+			if (best == nullptr) {
+				track.confidence = 0.0;
+				return;
+			}
+
+			// The votes of every position as candidates, most voted first, their share of the votes as score
+
+			std::vector<std::vector<LetterCandidate>> positions;
+
+			for (auto& position : *best) {
+				double total = 0.0;
+
+				for (auto& vote : position) {
+					total += vote.second;
+				}
+
+				std::vector<LetterCandidate> candidates;
+
+				for (auto& vote : position) {
+					LetterCandidate candidate;
+					candidate.letter = vote.first;
+					candidate.score = total > 0.0 ? vote.second / total : 0.0;
+					candidate.distance = -std::log(std::max(candidate.score, 1e-9));
+
+					candidates.push_back(candidate);
+				}
+
+				std::stable_sort(candidates.begin(), candidates.end(), [](auto& left, auto& right) { return left.score > right.score; });
+
+				positions.push_back(std::move(candidates));
+			}
+
+			if (grammar != nullptr && !grammar->Empty()) {
+				// The most voted reading the layout allows
+				track.text = pi::decodePlate(positions, *grammar);
+			}
+			else {
+				for (auto& candidates : positions) {
+					track.text += candidates.empty() ? '?' : candidates[0].letter;
+				}
+			}
+
+			for (int i = 0; i < (int)positions.size(); i++) {
+				double share = 0.0;
+
+				for (auto& candidate : positions[i]) {
+					if (candidate.letter == track.text[i]) {
+						share = candidate.score;
+						break;
+					}
+				}
+
+				track.letter_confidence.push_back(share);
+			}
+
+			// Agreement between the readings, held back until there are a few of them
+
+			double evidence = track.reads / (track.reads + 1.0);
+
+			track.confidence = pi::plateConfidence(track.letter_confidence) * evidence;
+		}
+	}
+
+	PlateTracker::PlateTracker(const TrackSettings& settings) : settings(settings) {}
+
+	std::vector<TrackMatch> PlateTracker::Update(const std::vector<cv::Rect>& boxes, const std::vector<cv::Mat>& plates) {
+		// Predict where every track moved to
+
+		std::vector<cv::Rect> predicted;
+
+		for (auto& track : tracks) {
+			predicted.push_back(stateBox(track.kalman.predict()));
+			track.age++;
+			track.missed++;
+		}
+
+		// Greedy association, best overlaps first
+
+		std::vector<std::tuple<double, int, int>> pairs;
+
+		for (int t = 0; t < (int)tracks.size(); t++) {
+			for (int d = 0; d < (int)boxes.size(); d++) {
+				double iou = pi::intersectionOverUnion(predicted[t], boxes[d]);
+
+				if (iou >= settings.iou_thresh) {
+					pairs.emplace_back(iou, t, d);
+				}
+			}
+		}
+
+		std::sort(pairs.begin(), pairs.end(), [](auto& left, auto& right) { return std::get<0>(left) > std::get<0>(right); });
+
+		std::vector<TrackMatch> matches(boxes.size());
+		std::vector<bool> track_used(tracks.size(), false);
+
+		for (auto& pair : pairs) {
+			int t = std::get<1>(pair), d = std::get<2>(pair);
+
+			if (track_used[t] || matches[d].track >= 0) {
+				continue;
+			}
+
+			track_used[t] = true;
+			matches[d].track = t;
+		}
+
+		// Matched tracks are corrected, unmatched detections start their own
+
+		for (int d = 0; d < (int)boxes.size(); d++) {
+			if (matches[d].track < 0) {
+				PlateTrack track;
+				track.id = next_id++;
+				initKalman(track.kalman, boxes[d]);
+
+				tracks.push_back(std::move(track));
+				track_used.push_back(true);
+
+				matches[d].track = (int)tracks.size() - 1;
+			}
+			else {
+				tracks[matches[d].track].kalman.correct(boxMeasurement(boxes[d]));
+			}
+
+			PlateTrack& track = tracks[matches[d].track];
+			track.box = boxes[d];
+			track.missed = 0;
+
+			bool changed = appearanceChange(track.appearance, plateThumbnail(plates[d])) > settings.appearance_thresh;
+			bool unsure = track.confidence < settings.reread_below && (settings.max_reads <= 0 || track.reads < settings.max_reads);
+
+			matches[d].needs_read = track.reads == 0 || changed || unsure;
+		}
+
+		// Drop the tracks that have been gone for too long, and remap the matches to the remaining indices
+
+		std::vector<int> remap(tracks.size(), -1);
+		std::vector<PlateTrack> kept;
+
+		for (int t = 0; t < (int)tracks.size(); t++) {
+			if (tracks[t].missed <= settings.max_missed) {
+				remap[t] = (int)kept.size();
+				kept.push_back(std::move(tracks[t]));
+			}
+		}
+
+		tracks = std::move(kept);
+
+		for (auto& match : matches) {
+			match.track = remap[match.track];
+		}
+
+		return matches;
+	}
+
+	void PlateTracker::AddReading(int index, const std::vector<std::vector<LetterCandidate>>& positions, const cv::Mat& plate, double confidence) {
+		PlateTrack& track = tracks[index];
+
+		std::vector<std::map<char, double>>& votes = track.votes[(int)positions.size()];
+		votes.resize(positions.size());
+
+		// Every candidate votes with its share of the letter, weighed by how sure the whole reading was
+
+		double weight = std::max(confidence, 1e-3);
+
+		for (int i = 0; i < (int)positions.size(); i++) {
+			for (auto& candidate : positions[i]) {
+				votes[i][candidate.letter] += candidate.score * weight;
+			}
+		}
+
+		track.appearance = plateThumbnail(plate);
+		track.reads++;
+
+		tallyVotes(track, settings.grammar);
+	}
+
+	const std::vector<PlateTrack>& PlateTracker::Tracks() const {
+		return tracks;
+	}
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	cv::Mat plateThumbnail(const cv::Mat& plate) {
+		cv::Mat gray;
+
+		if (plate.channels() == 3) {
+			cv::cvtColor(plate, gray, cv::COLOR_BGR2GRAY);
+		}
+		else {
+			gray = plate;
+		}
+
+		cv::Mat thumbnail;
+		cv::resize(gray, thumbnail, thumbnail_size, 0.0, 0.0, cv::INTER_AREA);
+
+		return thumbnail;
+	}
+}
@@ -0,0 +1,116 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Project_Headers.hpp"
+#include "Grammar.hpp"
+
+#include <opencv2/video/tracking.hpp>
+
+namespace pi {
+	/*************************************************************************************************/
+	/*                                       Defines & types                                         */
+	/*************************************************************************************************/
+
+	/*parameters for following plates from frame to frame*/
+	struct TrackSettings {
+		// Minimum overlap between the predicted box of a track and a detection to match them
+		double iou_thresh = 0.3;
+
+		// Frames a track survives without any matching detection
+		int max_missed = 10;
+
+		// Mean absolute difference of the plate thumbnails, in [0 ; 1], above which the plate is read again
+		double appearance_thresh = 0.12;
+
+		// Tracks whose voted reading is below this confidence are read again on every frame
+		double reread_below = 0.6;
+
+		// Readings after which a track is trusted whatever its confidence, 0 for no limit
+		int max_reads = 5;
+
+		// Layout the voted readings are decoded with, null to take the most voted character of every position
+		const PlateGrammar* grammar = nullptr;
+	};
+
+	/*one plate followed across frames, with the letter votes of every reading*/
+	struct PlateTrack {
+		int id = 0;
+
+		cv::KalmanFilter kalman;
+		cv::Rect box;
+
+		// Grayscale thumbnail of the rectified plate when it was last read
+		cv::Mat appearance;
+
+		int age = 0;
+		int missed = 0;
+		int reads = 0;
+
+		// Votes per letter count, then per position, then per character
+		std::map<int, std::vector<std::map<char, double>>> votes;
+
+		// Current result of the votes
+		std::string text;
+		std::vector<double> letter_confidence;
+		double confidence = 0.0;
+	};
+
+	/*the detection a track was matched with in the last update*/
+	struct TrackMatch {
+		int track = -1;          // Index in PlateTracker::Tracks()
+		bool needs_read = true;  // New track, changed appearance or not confident enough yet
+	};
+
+	/*IoU association with a constant velocity Kalman filter per plate, so every car is read a handful of times*/
+	class PlateTracker {
+	private:
+
+		std::vector<PlateTrack> tracks;
+		int next_id = 1;
+
+		TrackSettings settings;
+
+	public:
+
+		PlateTracker(const TrackSettings& settings = TrackSettings());
+
+		/**
+		 * \brief Function that advances the tracks by one frame and matches them with the detections
+		 *
+		 * \param[in] boxes - the plates detected in the frame
+		 *
+		 * \param[in] plates - the rectified plates, in the same order
+		 *
+		 * \param[out] matches - one entry per detection, unmatched detections start new tracks
+		 *
+		 * \note Tracks missed for more than max_missed frames are dropped, indices are only valid until the next update
+		 */
+		std::vector<TrackMatch> Update(const std::vector<cv::Rect>& boxes, const std::vector<cv::Mat>& plates);
+
+		/**
+		 * \brief Function that adds the reading of a plate to the votes of its track
+		 *
+		 * \param[in] positions - the candidates of every letter, with their scores
+		 *
+		 * \param[in] plate - the rectified plate that was read, kept to notice when it changes
+		 *
+		 * \param[in] confidence - confidence of the whole reading, weighs its votes
+		 */
+		void AddReading(int track, const std::vector<std::vector<LetterCandidate>>& positions, const cv::Mat& plate, double confidence);
+
+		const std::vector<PlateTrack>& Tracks() const;
+	};
+
+	/**************************************************************************************************/
+	/*                                     Public Functions                                          */
+	/**************************************************************************************************/
+
+	/**
+	 * \brief Function that makes the small grayscale thumbnail used to compare the appearance of a plate
+	 */
+	cv::Mat plateThumbnail(const cv::Mat& plate);
+}
@@ -0,0 +1,286 @@
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Video.hpp"
+
+#include <opencv2/videoio.hpp>
+
+namespace {
+	bool open_capture(cv::VideoCapture& capture, const std::string& source)
+	{
+		// A bare number is a camera index, anything else a file name or URL
+
+		bool is_index = !source.empty() && std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c); });
+
+		return is_index ? capture.open(std::stoi(source)) : capture.open(source);
+	}
+
+	// Detects every plate but only reads the ones the tracker asks for, the text of all of them comes from the votes
+	FrameResult track_frame(const FontData& fontData, const cv::Mat& frame, const DetectionSettings& detection,
+		const ReadSettings& read, pi::PlateTracker& tracker, std::vector<int>& track_ids, int64_t& reads)
+	{
+		FrameResult result;
+
+		auto start = std::chrono::steady_clock::now();
+
+		result.plates = detect_plate(fontData, frame, detection);
+
+		auto detected = std::chrono::steady_clock::now();
+
+		const PlateData& plates = result.plates;
+
+		std::vector<pi::TrackMatch> matches = tracker.Update(plates.plate_boxes, plates.segmented_plates);
+
+		// Only the new, changed or uncertain plates go through the reading
+
+		PlateData unread;
+		std::vector<int> unread_index;
+
+		for (size_t i = BASE_VALUE; i < matches.size(); i++)
+		{
+			if (!matches[i].needs_read)
+			{
+				continue;
+			}
+
+			unread.segmented_plates.push_back(plates.segmented_plates[i]);
+			unread.plate_specs.push_back(plates.plate_specs[i]);
+			unread.plate_scores.push_back(plates.plate_scores[i]);
+			unread.plate_boxes.push_back(plates.plate_boxes[i]);
+			unread.plate_corners.push_back(plates.plate_corners[i]);
+
+			unread_index.push_back(i);
+		}
+
+		if (!unread_index.empty())
+		{
+			PlateTextData text = detect_and_read_text(fontData, unread, read);
+
+			for (size_t k = BASE_VALUE; k < unread_index.size(); k++)
+			{
+				std::vector<std::vector<pi::LetterCandidate>> positions;
+
+				for (auto& letterInfo : text.plate_letters[k])
+				{
+					positions.emplace_back();
+
+					for (int c = BASE_VALUE; c < letterInfo.candidates.Size(); c++)
+					{
+						positions.back().push_back(letterInfo.candidates[c]);
+					}
+				}
+
+				int i = unread_index[k];
+				tracker.AddReading(matches[i].track, positions, plates.segmented_plates[i], text.plate_confidence[k]);
+			}
+
+			reads += unread_index.size();
+		}
+
+		// Every plate reports what its track voted for so far
+
+		track_ids.clear();
+
+		for (auto& match : matches)
+		{
+			const pi::PlateTrack& track = tracker.Tracks()[match.track];
+
+			std::vector<LetterInfo> letterList(track.text.size());
+
+			for (size_t j = BASE_VALUE; j < track.text.size(); j++)
+			{
+				letterList[j].letter = track.text[j];
+				letterList[j].confidence = track.letter_confidence[j];
+			}
+
+			result.text.plate_letters.push_back(std::move(letterList));
+			result.text.plate_text.push_back(track.text);
+			result.text.plate_confidence.push_back(track.confidence);
+
+			track_ids.push_back(track.id);
+		}
+
+		auto done = std::chrono::steady_clock::now();
+
+		result.times.detect = std::chrono::duration<double, std::milli>(detected - start).count();
+		result.times.read = std::chrono::duration<double, std::milli>(done - detected).count();
+
+		return result;
+	}
+}
+
+bool run_video(const FontData& fontData, const std::string& source,
+	const DetectionSettings& detection, const ReadSettings& read, const VideoSettings& settings)
+{
+	cv::VideoCapture capture;
+
+	if (!open_capture(capture, source))
+	{
+		std::cerr << "Failed to open video " << source << std::endl;
+		return false;
+	}
+
+	std::ofstream file;
+
+	if (!settings.output.empty())
+	{
+		file.open(settings.output);
+
+		if (!file.good())
+		{
+			std::cerr << "Failed to open " << settings.output << std::endl;
+			return false;
+		}
+	}
+
+	std::ostream& output = settings.output.empty() ? std::cout : file;
+
+	double fps = capture.get(cv::CAP_PROP_FPS);
+
+	if (!(fps > 0.0 && fps < 1000.0))
+	{
+		fps = settings.fallback_fps;
+	}
+
+	pi::WarpCache warp_cache;
+
+	DetectionSettings frame_detection = detection;
+	frame_detection.warp_cache = &warp_cache;
+	frame_detection.draw = false;
+
+	int stride = std::max(1, settings.stride);
+
+	int64_t index = -1;
+	int64_t processed = BASE_VALUE;
+	int64_t dropped = BASE_VALUE;
+	int64_t plates = BASE_VALUE;
+	int64_t reads = BASE_VALUE;
+	int64_t still = BASE_VALUE;
+
+	pi::MotionDetector motion(settings.motion_gate);
+
+	pi::TrackSettings tracking = settings.tracking;
+	tracking.grammar = read.grammar;
+
+	pi::PlateTracker tracker(tracking);
+	std::vector<int> track_ids;
+
+	double first_timestamp = -1.0;
+	double total_ms = 0.0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	cv::Mat frame;
+
+	while (capture.grab())
+	{
+		index++;
+
+		// Stream position of the frame, counted from the frame rate when the backend has no timestamps
+
+		double timestamp = capture.get(cv::CAP_PROP_POS_MSEC);
+
+		if (!(timestamp > 0.0) && index > BASE_VALUE)
+		{
+			timestamp = index * 1000.0 / fps;
+		}
+
+		if (first_timestamp < 0.0)
+		{
+			first_timestamp = timestamp;
+		}
+
+		if (index % stride != BASE_VALUE)
+		{
+			continue;
+		}
+
+		// Behind real time, drop this frame without decoding it and try the next one
+
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (settings.realtime && elapsed - (timestamp - first_timestamp) > settings.max_lag)
+		{
+			dropped++;
+			continue;
+		}
+
+		auto decode_start = std::chrono::steady_clock::now();
+
+		if (!capture.retrieve(frame) || frame.empty())
+		{
+			dropped++;
+			continue;
+		}
+
+		double decode = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decode_start).count();
+
+		// Nothing moved, there is no plate that wasn't already there in the previous frames
+
+		double motion_ms = 0.0;
+
+		if (settings.motion)
+		{
+			auto motion_start = std::chrono::steady_clock::now();
+
+			pi::MotionMap map = motion.Update(frame);
+
+			motion_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - motion_start).count();
+
+			if (!map.Moving())
+			{
+				total_ms += decode + motion_ms;
+				still++;
+				continue;
+			}
+
+			frame_detection.regions = std::move(map.regions);
+		}
+
+		FrameResult result = settings.track ?
+			track_frame(fontData, frame, frame_detection, read, tracker, track_ids, reads) :
+			process_frame(fontData, frame, frame_detection, read);
+
+		result.times.decode = decode;
+		result.times.detect += motion_ms;
+
+		plates += result.plates.segmented_plates.size();
+
+		if (!settings.track)
+		{
+			reads += result.plates.segmented_plates.size();
+		}
+
+		total_ms += result.times.decode + result.times.detect + result.times.read;
+		processed++;
+
+		output << "{\"frame\":" << index << ",\"timestamp_ms\":" << timestamp
+			<< ",\"plates\":" << plates_to_json(result);
+
+		if (settings.track)
+		{
+			output << ",\"tracks\":[";
+
+			for (size_t i = BASE_VALUE; i < track_ids.size(); i++)
+			{
+				output << (i > BASE_VALUE ? "," : "") << track_ids[i];
+			}
+
+			output << "]";
+		}
+
+		output << ",\"ms\":{\"decode\":" << result.times.decode << ",\"detect\":" << result.times.detect
+			<< ",\"read\":" << result.times.read << "}}\n";
+	}
+
+	output.flush();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << "Read " << index + 1 << " frames, processed " << processed << ", dropped " << dropped << ", still " << still
+		<< " in " << seconds << " s, " << processed / std::max(seconds, 1e-9) << " frames/s processed, "
+		<< total_ms / std::max<int64_t>(processed + still, 1) << " ms per frame, "
+		<< reads << " plate readings for " << plates << " plates seen" << std::endl;
+
+	return true;
+}
@@ -0,0 +1,57 @@
+/**************************************************************************************************/
+
+#pragma once
+
+/**************************************************************************************************/
+/*                                           Headers                                              */
+/**************************************************************************************************/
+#include "Pipeline.hpp"
+#include "Tracker.hpp"
+#include "Motion.hpp"
+
+/*************************************************************************************************/
+/*                                       Defines & types                                         */
+/*************************************************************************************************/
+
+struct VideoSettings
+{
+	// Only every stride-th frame is processed, the others are grabbed without being decoded
+	int stride = 1;
+
+	// Keep up with the frame timestamps, frames that are already late when their turn comes are dropped
+	bool realtime = true;
+
+	// How late a frame can be before it's dropped, in milliseconds
+	double max_lag = 100.0;
+
+	// Frame rate used when the source doesn't report one
+	double fallback_fps = 25.0;
+
+	// Follow plates across frames and only read them again when they change or are still uncertain
+	bool track = false;
+	pi::TrackSettings tracking;
+
+	// Skip frames where nothing moved and only search the parts that changed, for fixed cameras
+	bool motion = false;
+	pi::MotionSettings motion_gate;
+
+	// JSONL file the records go to, empty for the standard output
+	std::string output;
+};
+
+/**************************************************************************************************/
+/*                                     Public Functions                                          */
+/**************************************************************************************************/
+
+/**
+ * \brief Function that reads the plates of a video file, stream URL or camera index through cv::VideoCapture
+ *
+ * \param[out] returns false if the source couldn't be opened
+ *
+ * \note Writes one JSON record per processed frame with its index and timestamp
+ *       Dropped frames are grabbed but never decoded, so catching up costs little
+ *       With the motion gate, still frames are counted but produce no record
+ *       With tracking, every plate also carries its track id and the text voted over all of its readings
+ */
+bool run_video(const FontData& fontData, const std::string& source,
+	const DetectionSettings& detection, const ReadSettings& read, const VideoSettings& settings);